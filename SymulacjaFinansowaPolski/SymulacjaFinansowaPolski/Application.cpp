@@ -15,8 +15,17 @@ using namespace std;
 
 
 static Application* g_ApplicationInstance = nullptr;
+
+// Po zdarzeniu rysujemy kilka klatek: ImGui potrzebuje ich, żeby przetworzyć
+// wejście i ustabilizować stan (najechanie, otwarcie okna, fokus)
+static const int INPUT_FRAMES = 3;
+// Najdłuższy sen pętli bez zdarzeń
+static const double IDLE_TIMEOUT = 0.5;
+
 Application::Application() : window(nullptr), rangeMin(-10.0f), rangeMax(10.0f),
-                            showHelp(false), isDragging(false), lastMouseX(0), lastMouseY(0) {
+                            showHelp(false), isDragging(false), lastMouseX(0), lastMouseY(0),
+                            framebufferWidth(0), framebufferHeight(0), pendingFrames(0),
+                            renderedFrames(0), skippedFrames(0) {
     strcpy(equationInput, "y=x");
 }
 
@@ -49,6 +58,19 @@ bool Application::initGLFW() {
     glfwSetMouseButtonCallback(window, Application::mouseButtonCallback);
     glfwSetScrollCallback(window, Application::scrollCallback);
 
+    // Każde zdarzenie okna zleca przerysowanie. Ustawione przed ImGui, które
+    // przekazuje dalej wywołania tych, które samo przejmuje.
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) { Application::inputCallback(w); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* w, int) { Application::inputCallback(w); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) { Application::inputCallback(w); });
+    glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) { Application::inputCallback(w); });
+    glfwSetCharCallback(window, [](GLFWwindow* w, unsigned int) { Application::inputCallback(w); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int, int) { Application::inputCallback(w); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* w) { Application::inputCallback(w); });
+
+    // Gotowy wynik próbkowania budzi pętlę (glfwPostEmptyEvent działa z każdego wątku)
+    plotter.setResultCallback([] { glfwPostEmptyEvent(); });
+
     return true;
 }
 
@@ -57,11 +79,33 @@ void Application::initImGui() {
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     ImGui::StyleColorsDark();
+    io.ConfigInputTextCursorBlink = false;     // miganie wymagałoby ciągłego rysowania
 
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 120");
 }
 
+// Zakres próbkowania i rozmiar widoku w pikselach urządzenia (bufor ramki,
+// na ekranach HiDPI większy niż okno) dla próbkowania adaptacyjnego.
+void Application::syncPlotterView() {
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    if (width <= 0 || height <= 0) return;
+    framebufferWidth = width;
+    framebufferHeight = height;
+
+    float left, right, bottom, top;
+    coordSystem.getProjection(width, height, left, right, bottom, top);
+    plotter.setViewport(width, height, bottom, top);
+    plotter.setRange(left, right);
+    rangeMin = left;
+    rangeMax = right;
+}
+
+void Application::requestRedraw(int frames) {
+    pendingFrames = max(pendingFrames, frames);
+}
+
 void Application::render() {
     if (isDragging) {
         double mouseX, mouseY;
@@ -73,17 +117,19 @@ void Application::render() {
         float dy = static_cast<float>((mouseY - lastMouseY) / height);
 
         coordSystem.pan(-dx, dy);
+        syncPlotterView();
 
-        float xmin, xmax, ymin, ymax;
-        coordSystem.getViewRange(xmin, xmax, ymin, ymax);
-        plotter.setRange(xmin, xmax);
-
-        rangeMin = xmin;
-        rangeMax = xmax;
         lastMouseX = mouseX;
         lastMouseY = mouseY;
     }
 
+    // Zmiana rozmiaru okna albo przeniesienie na ekran o innej skali
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    if (width != framebufferWidth || height != framebufferHeight) {
+        syncPlotterView();
+    }
+
     glClearColor(0.08f, 0.08f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -119,22 +165,23 @@ void Application::render() {
         for (size_t i = 0; i < functions.size(); i++) {
             ImGui::PushID(static_cast<int>(i));
 
-            // Sprawdzanie błędów dla aktualnej funkcji
-            MathExpressionParser checker;
-            checker.setExpression(functions[i].expression);
-            string errorMsg = checker.getErrorMessage();
+            // Sprawdzanie błędów dla aktualnej funkcji (parser skompilowany przy dodaniu lub edycji)
+            const shared_ptr<const MathExpressionParser>& checker = functions[i].parser;
 
-            if (!errorMsg.empty()) {
+            if (checker && checker->hasError()) {
                 ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "[!] ");
                 if (ImGui::IsItemHovered()) {
-                    ImGui::SetTooltip("%s", errorMsg.c_str());
+                    ImGui::SetTooltip("%s", checker->getErrorMessage(functions[i].expression).c_str());
                 }
                 ImGui::SameLine();
             }
 
             ImGui::ColorEdit3("##color", (float*)&functions[i].color, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel);
             ImGui::SameLine();
-            ImGui::Checkbox("##enabled", &functions[i].enabled);
+            bool enabled = functions[i].enabled;
+            if (ImGui::Checkbox("##enabled", &enabled)) {
+                plotter.setFunctionEnabled(static_cast<int>(i), enabled);
+            }
             ImGui::SameLine();
 
             if (functions[i].editing) {
@@ -158,11 +205,10 @@ void Application::render() {
                     functions[i].cancelEdit();
                 }
                 
-                // Walidacja błędu na żywo podczas edycji
-                MathExpressionParser live;
-                live.setExpression(functions[i].editBuffer);
-                if (!live.getErrorMessage().empty()) {
-                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Error: %s", live.getErrorMessage().substr(0, 30).c_str());
+                // Walidacja błędu na żywo podczas edycji (parsowanie tylko po zmianie tekstu)
+                const string& editError = functions[i].validateEdit();
+                if (!editError.empty()) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Error: %s", editError.substr(0, 30).c_str());
                 }
             } else {
                 ImGui::Text("%s", functions[i].expression.c_str());
@@ -190,18 +236,14 @@ void Application::render() {
         float xmin, xmax, ymin, ymax;
         coordSystem.getViewRange(xmin, xmax, ymin, ymax);
         coordSystem.zoom(0.8f, (xmin + xmax) / 2.0f, (ymin + ymax) / 2.0f);
-        coordSystem.getViewRange(xmin, xmax, ymin, ymax);
-        plotter.setRange(xmin, xmax);
-        rangeMin = xmin; rangeMax = xmax;
+        syncPlotterView();
     }
     ImGui::SameLine();
     if (ImGui::Button("Zoom Out (-)", ImVec2(120, 25))) {
         float xmin, xmax, ymin, ymax;
         coordSystem.getViewRange(xmin, xmax, ymin, ymax);
         coordSystem.zoom(1.2f, (xmin + xmax) / 2.0f, (ymin + ymax) / 2.0f);
-        coordSystem.getViewRange(xmin, xmax, ymin, ymax);
-        plotter.setRange(xmin, xmax);
-        rangeMin = xmin; rangeMax = xmax;
+        syncPlotterView();
     }
 
     ImGui::Separator();
@@ -209,16 +251,18 @@ void Application::render() {
     ImGui::InputFloat("X max", &rangeMax);
     if (ImGui::Button("Apply Range")) {
         if (rangeMin >= rangeMax) swap(rangeMin, rangeMax);
-        plotter.setRange(rangeMin, rangeMax);
         coordSystem.setViewRange(rangeMin, rangeMax, -rangeMax, rangeMax);
+        syncPlotterView();
     }
     ImGui::SameLine();
     if (ImGui::Button("Reset View")) {
-        rangeMin = -10.0f; rangeMax = 10.0f;
-        plotter.setRange(rangeMin, rangeMax);
         coordSystem.resetView();
+        syncPlotterView();
     }
 
+    ImGui::Separator();
+    ImGui::Text("Frames: %llu drawn, %llu skipped", renderedFrames, skippedFrames);
+
     ImGui::End();
 
     if (showHelp) {
@@ -237,6 +281,13 @@ void Application::render() {
 }
 
 void Application::cleanup() {
+    // Czeka na trwające glfwPostEmptyEvent; potem wątek próbkujący nie
+    // odwołuje się już do GLFW, więc można je zamknąć
+    plotter.setResultCallback(nullptr);
+    if (window) {
+        plotter.releaseGraphics();
+        coordSystem.releaseGraphics();
+    }
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -248,6 +299,11 @@ void Application::cleanup() {
     g_ApplicationInstance = nullptr;
 }
 
+void Application::inputCallback(GLFWwindow* window) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app) app->requestRedraw(INPUT_FRAMES);
+}
+
 void Application::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
     if (app) app->onMouseButton(button, action, mods);
@@ -259,6 +315,7 @@ void Application::scrollCallback(GLFWwindow* window, double xoffset, double yoff
 }
 
 void Application::onMouseButton(int button, int action, int mods) {
+    requestRedraw(INPUT_FRAMES);
     if (button == GLFW_MOUSE_BUTTON_LEFT) {
         if (action == GLFW_PRESS) {
             isDragging = true;
@@ -270,6 +327,7 @@ void Application::onMouseButton(int button, int action, int mods) {
 }
 
 void Application::onScroll(double xoffset, double yoffset) {
+    requestRedraw(INPUT_FRAMES);
     (void)xoffset; (void)yoffset;
 }
 
@@ -277,12 +335,30 @@ int Application::run() {
     if (!initGLFW()) return -1;
     initImGui();
 
-    plotter.setRange(rangeMin, rangeMax);
     coordSystem.setViewRange(rangeMin, rangeMax, -rangeMax, rangeMax);
-
+    syncPlotterView();
+
+    // Rysujemy tylko na żądanie: po zdarzeniu okna i po nowym wyniku
+    // próbkowania. Przeciąganie nie jest wyjątkiem: ruch kursora i kółko
+    // wołają inputCallback, więc nieruchoma, wciśnięta mysz nie kręci
+    // pętli. Bez pracy pętla śpi w glfwWaitEventsTimeout, a każde
+    // przebudzenie bez rysowania liczy się jako pominięta klatka.
+    requestRedraw(INPUT_FRAMES);
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-        render();
+        if (pendingFrames > 0) glfwPollEvents();
+        else glfwWaitEventsTimeout(IDLE_TIMEOUT);
+
+        // Przed zleceniem nowego próbkowania w render(), żeby wynik dla
+        // bieżącego widoku nie został uznany za nieaktualny
+        if (plotter.pollResults()) requestRedraw(1);
+
+        if (pendingFrames > 0) {
+            render();
+            renderedFrames++;
+            pendingFrames--;
+        } else {
+            skippedFrames++;
+        }
     }
 
     cleanup();
@@ -18,12 +18,18 @@ private:
     bool showHelp;
     bool isDragging;
     double lastMouseX, lastMouseY;
+    int framebufferWidth, framebufferHeight;    // rozmiar, dla którego próbkowano wykresy
+    int pendingFrames;                          // ile klatek jeszcze narysować
+    unsigned long long renderedFrames, skippedFrames;
 
     bool initGLFW();
     void initImGui();
     void render();
     void cleanup();
+    void syncPlotterView();
+    void requestRedraw(int frames);
 
+    static void inputCallback(GLFWwindow* window);
     static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 
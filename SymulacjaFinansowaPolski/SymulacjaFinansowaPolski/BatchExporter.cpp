@@ -0,0 +1,253 @@
+// glGenFramebuffersEXT i pokrewne: w Mesie GL/gl.h (przez GLHeaders.h) dołącza
+// GL/glext.h z prototypami, a na macOS OpenGL/gl.h tego nie robi, więc
+// OpenGL/glext.h dołączamy sami
+#define GL_GLEXT_PROTOTYPES
+#include "BatchExporter.h"
+#ifdef __APPLE__
+#include <OpenGL/glext.h>
+#endif
+#include "ExpressionCache.h"
+#include "MathExpressionParser.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+using namespace std;
+
+static const int MAX_IMAGE_SIZE = 16384;
+
+ExportJob::ExportJob() : width(0), height(0), xMin(0.0f), xMax(0.0f), yMin(0.0f), yMax(0.0f) {}
+
+#ifdef __linux__
+struct BatchExporter::OffscreenContext {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+
+    ~OffscreenContext() {
+        if (display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+};
+#else
+struct BatchExporter::OffscreenContext {
+    bool initialized = false;
+    GLFWwindow* window = nullptr;
+
+    ~OffscreenContext() {
+        if (window) glfwDestroyWindow(window);
+        if (initialized) glfwTerminate();
+    }
+};
+#endif
+
+BatchExporter::BatchExporter() : framebuffer(0), colorBuffer(0), bufferWidth(0), bufferHeight(0), skippedEquations(0) {}
+
+BatchExporter::~BatchExporter() {
+    if (context) releaseGraphics();
+}
+
+// Na Linuksie platforma surfaceless Mesy nie potrzebuje ani serwera
+// X/Wayland, ani urządzenia DRM (wtedy rysuje llvmpipe); bez niej domyślny
+// ekran EGL. Gdzie indziej (macOS) kontekst daje niewidoczne okno GLFW
+// o takich samych ustawieniach jak okno aplikacji; jego bufor nie jest używany.
+bool BatchExporter::initContext() {
+#ifdef __linux__
+    auto offscreen = make_unique<OffscreenContext>();
+
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay) {
+        offscreen->display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (offscreen->display == EGL_NO_DISPLAY) offscreen->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (offscreen->display == EGL_NO_DISPLAY || !eglInitialize(offscreen->display, nullptr, nullptr)) {
+        cerr << "Nie mozna zainicjalizowac EGL" << endl;
+        offscreen->display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    // Domyślny EGL_SURFACE_TYPE to okno, którego tu nie ma
+    const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(offscreen->display, configAttributes, &config, 1, &configCount) || configCount == 0 ||
+        !eglBindAPI(EGL_OPENGL_API)) {
+        cerr << "EGL nie obsluguje OpenGL" << endl;
+        return false;
+    }
+
+    // Bez atrybutów: profil zgodności, jak kontekst 2.1 w oknie
+    offscreen->context = eglCreateContext(offscreen->display, config, EGL_NO_CONTEXT, nullptr);
+    if (offscreen->context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(offscreen->display, EGL_NO_SURFACE, EGL_NO_SURFACE, offscreen->context)) {
+        cerr << "Nie mozna utworzyc kontekstu OpenGL bez powierzchni" << endl;
+        return false;
+    }
+
+    context = move(offscreen);
+    return true;
+#else
+    auto offscreen = make_unique<OffscreenContext>();
+#ifdef GLFW_COCOA_MENUBAR
+    glfwInitHint(GLFW_COCOA_MENUBAR, GLFW_FALSE);
+#endif
+    if (!glfwInit()) {
+        cerr << "Nie mozna zainicjalizowac GLFW" << endl;
+        return false;
+    }
+    offscreen->initialized = true;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    offscreen->window = glfwCreateWindow(64, 64, "Batch export", nullptr, nullptr);
+    if (!offscreen->window) {
+        cerr << "Nie mozna utworzyc kontekstu OpenGL" << endl;
+        return false;
+    }
+    glfwMakeContextCurrent(offscreen->window);
+
+    context = move(offscreen);
+    return true;
+#endif
+}
+
+// Kontekst 2.1 na macOS zna bufory ramki tylko jako GL_EXT_framebuffer_object;
+// Mesa też je udostępnia, więc obie platformy używają wersji EXT
+bool BatchExporter::resizeFramebuffer(int width, int height) {
+    if (width == bufferWidth && height == bufferHeight) return true;
+    if (framebuffer == 0) {
+        glGenFramebuffersEXT(1, &framebuffer);
+        glGenRenderbuffersEXT(1, &colorBuffer);
+    }
+    glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, colorBuffer);
+    glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, width, height);
+    glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, framebuffer);
+    glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, colorBuffer);
+    if (glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) != GL_FRAMEBUFFER_COMPLETE_EXT) {
+        cerr << "Niekompletny bufor ramki " << width << "x" << height << endl;
+        bufferWidth = bufferHeight = 0;
+        return false;
+    }
+    bufferWidth = width;
+    bufferHeight = height;
+    return true;
+}
+
+void BatchExporter::releaseGraphics() {
+    plotter.releaseGraphics();
+    coordSystem.releaseGraphics();
+    if (framebuffer != 0) {
+        glDeleteFramebuffersEXT(1, &framebuffer);
+        glDeleteRenderbuffersEXT(1, &colorBuffer);
+    }
+    framebuffer = colorBuffer = 0;
+    bufferWidth = bufferHeight = 0;
+}
+
+// Zakres widoku jest dopasowywany do proporcji obrazu tak jak w oknie
+// (CoordinateSystem::getProjection); obraz ma skalę 1, więc rozmiar
+// logiczny jest równy rozmiarowi w pikselach. Błędne równanie jest zgłaszane
+// i pomijane, a wykres powstaje z pozostałych.
+bool BatchExporter::render(const ExportJob& job) {
+    vector<string> equations;
+    for (const string& equation : job.equations) {
+        auto parser = getExpressionCache().get(equation);
+        if (parser->hasError()) {
+            cerr << job.path << ": pominieto " << equation << ": " << parser->getErrorMessage(equation) << endl;
+            skippedEquations++;
+            continue;
+        }
+        equations.push_back(equation);
+    }
+    if (!resizeFramebuffer(job.width, job.height)) return false;
+
+    coordSystem.setViewRange(job.xMin, job.xMax, job.yMin, job.yMax);
+    float left, right, bottom, top;
+    coordSystem.getProjection(job.width, job.height, left, right, bottom, top);
+
+    // Najpierw widok, potem funkcje: pusty ploter niczego nie zleca,
+    // a wszystkie funkcje wykresu trafiają do jednego zlecenia
+    plotter.clear();
+    plotter.setViewport(job.width, job.height, bottom, top);
+    plotter.setRange(left, right);
+    plotter.addFunctions(equations);
+    plotter.synchronize();
+
+    glViewport(0, 0, job.width, job.height);
+    glClearColor(0.08f, 0.08f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    coordSystem.draw(job.width, job.height, job.width, job.height);
+    plotter.draw();
+
+    // OpenGL zwraca wiersze od dołu, PNG zapisuje od góry
+    size_t stride = (size_t)job.width * 3;
+    pixels.resize(stride * job.height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, job.width, job.height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    for (int row = 0; row < job.height / 2; row++) {
+        swap_ranges(pixels.begin() + row * stride, pixels.begin() + (row + 1) * stride,
+                    pixels.begin() + (job.height - 1 - row) * stride);
+    }
+
+    if (!pngWriter.write(job.path, job.width, job.height, pixels)) {
+        cerr << "Nie mozna zapisac " << job.path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool BatchExporter::parseJob(const string& line, ExportJob& job) {
+    istringstream stream(line);
+    if (!(stream >> job.path >> job.width >> job.height >> job.xMin >> job.xMax >> job.yMin >> job.yMax)) return false;
+    if (job.width <= 0 || job.height <= 0 || job.width > MAX_IMAGE_SIZE || job.height > MAX_IMAGE_SIZE) return false;
+    if (!(job.xMin < job.xMax) || !(job.yMin < job.yMax)) return false;
+
+    job.equations.clear();
+    string rest, equation;
+    getline(stream, rest);
+    istringstream equations(rest);
+    while (getline(equations, equation, ';')) {
+        size_t first = equation.find_first_not_of(" \t\r");
+        if (first == string::npos) continue;
+        size_t last = equation.find_last_not_of(" \t\r");
+        job.equations.push_back(equation.substr(first, last - first + 1));
+    }
+    return true;
+}
+
+int BatchExporter::run(istream& input) {
+    if (!context && !initContext()) return 1;
+
+    skippedEquations = 0;
+    auto start = chrono::steady_clock::now();
+    int written = 0, failed = 0, lineNumber = 0;
+    string line;
+    ExportJob job;
+    while (getline(input, line)) {
+        lineNumber++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') continue;
+
+        if (!parseJob(line, job)) {
+            cerr << "Wiersz " << lineNumber << ": niepoprawne zadanie" << endl;
+            failed++;
+            continue;
+        }
+        if (render(job)) written++;
+        else failed++;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Zapisano " << written << " wykresow (bledy: " << failed << ", pominiete rownania: " << skippedEquations
+         << ") w " << seconds << " s" << endl;
+    return failed == 0 && skippedEquations == 0 ? 0 : 1;
+}
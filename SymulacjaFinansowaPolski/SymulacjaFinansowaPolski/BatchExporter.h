@@ -0,0 +1,64 @@
+#ifndef BATCHEXPORTER_H
+#define BATCHEXPORTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include "GLHeaders.h"
+#include "CoordinateSystem.h"
+#include "MultiFunctionPlotter.h"
+#include "PngWriter.h"
+
+// Jeden wykres do wyeksportowania
+struct ExportJob {
+    std::string path;
+    int width, height;
+    float xMin, xMax, yMin, yMax;
+    std::vector<std::string> equations;
+
+    ExportJob();
+};
+
+// Eksport wykresów do PNG bez okna: kontekst EGL bez powierzchni na Linuksie
+// (Mesa, także bez GPU i serwera wyświetlania), niewidoczne okno GLFW na
+// macOS, a rysowanie zawsze do bufora ramki poza ekranem.
+// Rysowanie idzie tymi samymi ścieżkami co w oknie (CoordinateSystem,
+// MultiFunctionPlotter), a kontekst, bufor ramki i pamięć próbkowania
+// są używane ponownie przez cały przebieg.
+//
+// Lista zadań: jeden wykres w wierszu,
+//     plik.png szerokość wysokość xMin xMax yMin yMax równanie; równanie; ...
+// Puste wiersze i zaczynające się od # są pomijane. Kod wyjścia jest
+// niezerowy także wtedy, gdy któreś równanie pominięto z powodu błędu.
+class BatchExporter {
+private:
+    struct OffscreenContext;
+
+    std::unique_ptr<OffscreenContext> context;
+    CoordinateSystem coordSystem;
+    MultiFunctionPlotter plotter;
+    PngWriter pngWriter;
+    GLuint framebuffer, colorBuffer;
+    int bufferWidth, bufferHeight;
+    int skippedEquations;       // błędne równania w bieżącym przebiegu run()
+    std::vector<unsigned char> pixels;
+
+    bool initContext();
+    bool resizeFramebuffer(int width, int height);
+    bool render(const ExportJob& job);
+    void releaseGraphics();
+
+public:
+    BatchExporter();
+    ~BatchExporter();
+    BatchExporter(const BatchExporter&) = delete;
+    BatchExporter& operator=(const BatchExporter&) = delete;
+
+    static bool parseJob(const std::string& line, ExportJob& job);
+
+    // Zwraca kod wyjścia: 0 gdy wszystkie wykresy zapisano w całości
+    int run(std::istream& input);
+};
+
+#endif // BATCHEXPORTER_H
@@ -1,12 +1,16 @@
+// glGenBuffers z glext.h (Mesa); na macOS bez znaczenia
+#define GL_GLEXT_PROTOTYPES
 #include "CoordinateSystem.h"
 #include <cmath>
-#include <GLFW/glfw3.h>
+#include <cstddef>
 
 using namespace std;
 
 CoordinateSystem::CoordinateSystem() :
     viewXMin(-10.0f), viewXMax(10.0f), viewYMin(-10.0f), viewYMax(10.0f),
-    baseXMin(-10.0f), baseXMax(10.0f), baseYMin(-10.0f), baseYMax(10.0f) {}
+    baseXMin(-10.0f), baseXMax(10.0f), baseYMin(-10.0f), baseYMax(10.0f),
+    lastViewLeft(-10.0f), lastViewRight(10.0f), lastViewBottom(-10.0f), lastViewTop(10.0f),
+    gridKey(), gridBuilt(false), gridBuffer(0), triangleVertices(0), lineVertices(0) {}
 
 float CoordinateSystem::getSpacing(float range) {
     if (range > 50.0f) return 5.0f;
@@ -16,48 +20,87 @@ float CoordinateSystem::getSpacing(float range) {
     return 1.0f;
 }
 
-void CoordinateSystem::drawArrows(float viewLeft, float viewRight, float viewBottom, float viewTop) {
-    glColor3f(0.8f, 0.8f, 0.8f);
+bool CoordinateSystem::GridKey::operator==(const GridKey& other) const {
+    return left == other.left && right == other.right && bottom == other.bottom && top == other.top &&
+           xMin == other.xMin && xMax == other.xMax && yMin == other.yMin && yMax == other.yMax &&
+           width == other.width && height == other.height;
+}
 
-    float viewRangeX = viewRight - viewLeft;
-    float viewRangeY = viewTop - viewBottom;
-    
-    float arrowLength = viewRangeX * 0.015f;
-    float arrowWidth = viewRangeY * 0.015f / 2.0f;
+void CoordinateSystem::addVertex(float x, float y, float gray) {
+    unsigned char c = (unsigned char)lround(gray * 255.0f);
+    gridVertices.push_back({ x, y, { c, c, c, 255 } });
+}
+
+// Osie jako prostokąty grubości 1,5 piksela bufora ramki, żeby zmieściły
+// się w jednym wywołaniu z grotami (bez zmiany glLineWidth)
+void CoordinateSystem::addAxes(const GridKey& key) {
+    const float AXIS_PIXELS = 1.5f;
+    float halfX = (key.right - key.left) / key.width * AXIS_PIXELS / 2.0f;
+    float halfY = (key.top - key.bottom) / key.height * AXIS_PIXELS / 2.0f;
+    const float gray = 0.4f;
+
+    addVertex(key.left, -halfY, gray);
+    addVertex(key.right, -halfY, gray);
+    addVertex(key.right, halfY, gray);
+    addVertex(key.left, -halfY, gray);
+    addVertex(key.right, halfY, gray);
+    addVertex(key.left, halfY, gray);
+
+    addVertex(-halfX, key.bottom, gray);
+    addVertex(halfX, key.bottom, gray);
+    addVertex(halfX, key.top, gray);
+    addVertex(-halfX, key.bottom, gray);
+    addVertex(halfX, key.top, gray);
+    addVertex(-halfX, key.top, gray);
+}
 
+void CoordinateSystem::addArrows(float viewLeft, float viewRight, float viewBottom, float viewTop) {
     float ARROW_SCALE = 0.015f;
     float baseSizeX = (viewRight - viewLeft) * ARROW_SCALE;
     float baseSizeY = (viewTop - viewBottom) * ARROW_SCALE;
     
     float DLUGOSC_GROTA = baseSizeX;
     float POLOWA_SZEROKOSCI_GROTA = baseSizeY / 2.0f;
+    const float gray = 0.8f;
 
+    addVertex(viewRight, 0.0f, gray);
+    addVertex(viewRight - DLUGOSC_GROTA, POLOWA_SZEROKOSCI_GROTA, gray);
+    addVertex(viewRight - DLUGOSC_GROTA, -POLOWA_SZEROKOSCI_GROTA, gray);
 
-    glBegin(GL_TRIANGLES);
+    addVertex(0.0f, viewTop, gray);
+    addVertex(POLOWA_SZEROKOSCI_GROTA, viewTop - DLUGOSC_GROTA, gray);
+    addVertex(-POLOWA_SZEROKOSCI_GROTA, viewTop - DLUGOSC_GROTA, gray);
+}
 
-    glVertex2f(viewRight, 0.0f);
-    glVertex2f(viewRight - DLUGOSC_GROTA, POLOWA_SZEROKOSCI_GROTA);
-    glVertex2f(viewRight - DLUGOSC_GROTA, -POLOWA_SZEROKOSCI_GROTA);
+// Linie siatki poza osiami; indeks całkowity zamiast sumowania kroków float
+void CoordinateSystem::addGridLines(const GridKey& key, float xSpacing, float ySpacing) {
+    const float gray = 0.2f;
 
-    glVertex2f(0.0f, viewTop);
-    glVertex2f(POLOWA_SZEROKOSCI_GROTA, viewTop - DLUGOSC_GROTA);
-    glVertex2f(-POLOWA_SZEROKOSCI_GROTA, viewTop - DLUGOSC_GROTA);
+    long long xFirst = (long long)ceil(key.left / xSpacing), xLast = (long long)floor(key.right / xSpacing);
+    for (long long k = xFirst; k <= xLast; k++) {
+        if (k == 0) continue;
+        addVertex(k * xSpacing, key.bottom, gray);
+        addVertex(k * xSpacing, key.top, gray);
+    }
 
-    glEnd();
+    long long yFirst = (long long)ceil(key.bottom / ySpacing), yLast = (long long)floor(key.top / ySpacing);
+    for (long long k = yFirst; k <= yLast; k++) {
+        if (k == 0) continue;
+        addVertex(key.left, k * ySpacing, gray);
+        addVertex(key.right, k * ySpacing, gray);
+    }
 }
 
-void CoordinateSystem::drawAxisLabels(float xSpacing, float ySpacing) {
-    glColor3f(0.7f, 0.7f, 0.7f);
+void CoordinateSystem::addTicks(float xSpacing, float ySpacing) {
+    const float gray = 0.7f;
 
     int startX = static_cast<int>(ceil(viewXMin / xSpacing));
     int endX = static_cast<int>(floor(viewXMax / xSpacing));
 
     for (int x = startX; x <= endX; x++) {
         if (x != 0) {
-            glBegin(GL_LINES);
-            glVertex2f(x * xSpacing, -0.1f);
-            glVertex2f(x * xSpacing, 0.1f);
-            glEnd();
+            addVertex(x * xSpacing, -0.1f, gray);
+            addVertex(x * xSpacing, 0.1f, gray);
         }
     }
 
@@ -66,44 +109,55 @@ void CoordinateSystem::drawAxisLabels(float xSpacing, float ySpacing) {
 
     for (int y = startY; y <= endY; y++) {
         if (y != 0) {
-            glBegin(GL_LINES);
-            glVertex2f(-0.1f, y * ySpacing);
-            glVertex2f(0.1f, y * ySpacing);
-            glEnd();
+            addVertex(-0.1f, y * ySpacing, gray);
+            addVertex(0.1f, y * ySpacing, gray);
         }
     }
 }
 
+// Najpierw trójkąty (osie, groty), potem linie: siatka i na końcu
+// znaczniki, żeby leżały na osiach
+void CoordinateSystem::buildGrid(const GridKey& key) {
+    float xSpacing = getSpacing(key.right - key.left);
+    float ySpacing = getSpacing(key.top - key.bottom);
+
+    gridVertices.clear();
+    addAxes(key);
+    addArrows(key.left, key.right, key.bottom, key.top);
+    triangleVertices = (GLsizei)gridVertices.size();
+    addGridLines(key, xSpacing, ySpacing);
+    addTicks(xSpacing, ySpacing);
+    lineVertices = (GLsizei)gridVertices.size() - triangleVertices;
+
+    if (gridBuffer == 0) glGenBuffers(1, &gridBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, gridBuffer);
+    glBufferData(GL_ARRAY_BUFFER, gridVertices.size() * sizeof(GridVertex), gridVertices.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    gridKey = key;
+    gridBuilt = true;
+}
+
+#ifndef HEADLESS_EXPORT
 void CoordinateSystem::draw(GLFWwindow* window) {
     int windowWidth, windowHeight;
     glfwGetWindowSize(window, &windowWidth, &windowHeight);
-    float aspect = (float)windowWidth / windowHeight;
-
-    float currentWidth = viewXMax - viewXMin;
-    float currentHeight = viewYMax - viewYMin;
-
-    float centerX = (viewXMin + viewXMax) / 2.0f;
-    float centerY = (viewYMin + viewYMax) / 2.0f;
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    draw(windowWidth, windowHeight, framebufferWidth, framebufferHeight);
+}
+#endif
 
-    float targetWidth, targetHeight;
+void CoordinateSystem::draw(int windowWidth, int windowHeight, int framebufferWidth, int framebufferHeight) {
+    if (windowWidth <= 0 || windowHeight <= 0 || framebufferWidth <= 0 || framebufferHeight <= 0) return;
 
-    if (aspect > 1.0f) {
-        targetHeight = currentHeight;
-        targetWidth = targetHeight * aspect;
-    } else {
-        targetWidth = currentWidth;
-        targetHeight = targetWidth / aspect;
-    }
-    
-    float viewLeft = centerX - targetWidth / 2.0f;
-        float viewRight = centerX + targetWidth / 2.0f;
-        float viewBottom = centerY - targetHeight / 2.0f;
-        float viewTop = centerY + targetHeight / 2.0f;
+    float viewLeft, viewRight, viewBottom, viewTop;
+    getProjection(windowWidth, windowHeight, viewLeft, viewRight, viewBottom, viewTop);
 
     lastViewLeft = viewLeft;
-        lastViewRight = viewRight;
-        lastViewBottom = viewBottom;
-        lastViewTop = viewTop;
+    lastViewRight = viewRight;
+    lastViewBottom = viewBottom;
+    lastViewTop = viewTop;
     
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -112,67 +166,26 @@ void CoordinateSystem::draw(GLFWwindow* window) {
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    glColor3f(0.12f, 0.12f, 0.12f);
-    glBegin(GL_LINES);
-
-    float xSpacing = getSpacing(targetWidth);
-    float ySpacing = getSpacing(targetHeight);
-
-    float xStart = ceil(viewLeft / xSpacing) * xSpacing;
-    float xEnd = viewRight;
-    for (float x = xStart; x <= xEnd; x += xSpacing) {
-        if (fabs(x) > 0.0001f) {
-            glVertex2f(x, viewBottom);
-            glVertex2f(x, viewTop);
-        }
-    }
-
-    float yStart = ceil(viewBottom / ySpacing) * ySpacing;
-    float yEnd = viewTop;
-    for (float y = yStart; y <= yEnd; y += ySpacing) {
-        if (fabs(y) > 0.0001f) {
-            glVertex2f(viewLeft, y);
-            glVertex2f(viewRight, y);
-        }
-    }
-
-    glEnd();
-
-    //pogrubione osie
-    glColor3f(0.4f, 0.4f, 0.4f);
-    glLineWidth(1.5f);
-    glBegin(GL_LINES);
-
-    glVertex2f(viewLeft, 0.0f);
-    glVertex2f(viewRight, 0.0f);
-
-    glVertex2f(0.0f, viewBottom);
-    glVertex2f(0.0f, viewTop);
-
-    glEnd();
-    glLineWidth(1.0f);
-
-    drawArrows(viewLeft, viewRight, viewBottom, viewTop);
-    drawAxisLabels(xSpacing, ySpacing);
-
-    glColor3f(0.2f, 0.2f, 0.2f);
-    glBegin(GL_LINES);
-
-    for (float y = yStart; y <= yEnd; y += ySpacing) {
-        if (fabs(y) > 0.0001f) {
-            glVertex2f(viewLeft, y);
-            glVertex2f(viewRight, y);
-        }
-    }
-
-    for (float x = xStart; x <= xEnd; x += xSpacing) {
-        if (fabs(x) > 0.0001f) {
-            glVertex2f(x, viewBottom);
-            glVertex2f(x, viewTop);
-        }
-    }
+    GridKey key = { viewLeft, viewRight, viewBottom, viewTop, viewXMin, viewXMax, viewYMin, viewYMax,
+                    framebufferWidth, framebufferHeight };
+    if (!gridBuilt || !(key == gridKey)) buildGrid(key);
+
+    glBindBuffer(GL_ARRAY_BUFFER, gridBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(GridVertex), (const void*)offsetof(GridVertex, x));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(GridVertex), (const void*)offsetof(GridVertex, color));
+    glDrawArrays(GL_TRIANGLES, 0, triangleVertices);
+    glDrawArrays(GL_LINES, triangleVertices, lineVertices);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-    glEnd();
+void CoordinateSystem::releaseGraphics() {
+    if (gridBuffer != 0) glDeleteBuffers(1, &gridBuffer);
+    gridBuffer = 0;
+    gridBuilt = false;
 }
 
 void CoordinateSystem::setViewRange(float xmin, float xmax, float ymin, float ymax) {
@@ -219,6 +232,31 @@ void CoordinateSystem::getViewRange(float& xmin, float& xmax, float& ymin, float
         ymax = lastViewTop;
 }
 
+// Widoczny obszar dla okna width x height: krótszy bok pokazuje zakres
+// widoku, dłuższy jest rozciągnięty tak, żeby zachować proporcje.
+void CoordinateSystem::getProjection(int width, int height, float& left, float& right, float& bottom, float& top) const {
+    float aspect = (float)width / height;
+
+    float centerX = (viewXMin + viewXMax) / 2.0f;
+    float centerY = (viewYMin + viewYMax) / 2.0f;
+
+    float targetWidth, targetHeight;
+
+    if (aspect > 1.0f) {
+        targetHeight = viewYMax - viewYMin;
+        targetWidth = targetHeight * aspect;
+    } else {
+        targetWidth = viewXMax - viewXMin;
+        targetHeight = targetWidth / aspect;
+    }
+
+    left = centerX - targetWidth / 2.0f;
+    right = centerX + targetWidth / 2.0f;
+    bottom = centerY - targetHeight / 2.0f;
+    top = centerY + targetHeight / 2.0f;
+}
+
+#ifndef HEADLESS_EXPORT
 void CoordinateSystem::screenToGraph(GLFWwindow* window, int screenX, int screenY, float& graphX, float& graphY) {
     int width, height;
     glfwGetWindowSize(window, &width, &height);
@@ -242,3 +280,4 @@ void CoordinateSystem::screenToGraph(GLFWwindow* window, int screenX, int screen
     graphX = centerX - targetWidth/2 + (screenX / (float)width) * targetWidth;
     graphY = centerY + targetHeight/2 - (screenY / (float)height) * targetHeight;
 }
+#endif
@@ -1,26 +1,61 @@
 #ifndef COORDINATESYSTEM_H
 #define COORDINATESYSTEM_H
 
-#include <GLFW/glfw3.h>
+#include <vector>
+#include "GLHeaders.h"
 
+// Siatka, osie z grotami i znaczniki leżą w jednym buforze wierzchołków,
+// przebudowywanym tylko po zmianie widoku lub rozmiaru bufora ramki;
+// rysowanie to dwa wywołania (trójkąty osi i grotów, linie siatki i znaczników).
 class CoordinateSystem {
 private:
+    struct GridVertex {
+        float x, y;
+        unsigned char color[4];
+    };
+    // Dla czego zbudowano gridVertices
+    struct GridKey {
+        float left, right, bottom, top;
+        float xMin, xMax, yMin, yMax;
+        int width, height;
+        bool operator==(const GridKey& other) const;
+    };
+
     float viewXMin, viewXMax, viewYMin, viewYMax;
     float baseXMin, baseXMax, baseYMin, baseYMax;
     float lastViewLeft, lastViewRight, lastViewBottom, lastViewTop;
+    std::vector<GridVertex> gridVertices;
+    GridKey gridKey;
+    bool gridBuilt;
+    GLuint gridBuffer;
+    GLsizei triangleVertices, lineVertices;
+
     float getSpacing(float range);
-    void drawArrows(float viewLeft, float viewRight, float viewBottom, float viewTop);
-    void drawAxisLabels(float xSpacing, float ySpacing);
+    void buildGrid(const GridKey& key);
+    void addAxes(const GridKey& key);
+    void addArrows(float viewLeft, float viewRight, float viewBottom, float viewTop);
+    void addGridLines(const GridKey& key, float xSpacing, float ySpacing);
+    void addTicks(float xSpacing, float ySpacing);
+    void addVertex(float x, float y, float gray);
     
+
 public:
     CoordinateSystem();
+#ifndef HEADLESS_EXPORT
     void draw(GLFWwindow* window);
+#endif
+    // Bez okna: rzutowanie z rozmiaru logicznego, siatka w pikselach bufora ramki
+    void draw(int windowWidth, int windowHeight, int framebufferWidth, int framebufferHeight);
     void setViewRange(float xmin, float xmax, float ymin, float ymax);
     void zoom(float factor, float centerX, float centerY);
     void pan(float dx, float dy);
     void resetView();
     void getViewRange(float& xmin, float& xmax, float& ymin, float& ymax) const;
+    void getProjection(int width, int height, float& left, float& right, float& bottom, float& top) const;
+#ifndef HEADLESS_EXPORT
     void screenToGraph(GLFWwindow* window, int screenX, int screenY, float& graphX, float& graphY);  // CHANGED
+#endif
+    void releaseGraphics();     // przed zniszczeniem kontekstu GL
 };
 
 #endif
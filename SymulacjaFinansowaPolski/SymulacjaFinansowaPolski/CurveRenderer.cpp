@@ -0,0 +1,75 @@
+// glGenBuffers i glMultiDrawArrays z glext.h (Mesa); na macOS bez znaczenia
+#define GL_GLEXT_PROTOTYPES
+#include "CurveRenderer.h"
+
+using namespace std;
+
+// Bufor rośnie tylko wtedy, gdy krzywa się nie mieści; mniejsze krzywe
+// nadpisują początek istniejącego
+void CurveRenderer::upload(Buffer& buffer, const FunctionData& func) {
+    const Polyline& curve = func.rendered;
+    size_t n = curve.size();
+    staging.resize(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        staging[2 * i] = curve.x[i];
+        staging[2 * i + 1] = curve.y[i];
+    }
+
+    if (buffer.vbo == 0) glGenBuffers(1, &buffer.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+    if (n > buffer.capacity) {
+        glBufferData(GL_ARRAY_BUFFER, staging.size() * sizeof(float), staging.data(), GL_DYNAMIC_DRAW);
+        buffer.capacity = n;
+    } else if (n > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, staging.size() * sizeof(float), staging.data());
+    }
+
+    buffer.firsts.clear();
+    buffer.counts.clear();
+    for (const PolylineSegment& segment : curve.segments) {
+        if (segment.end - segment.begin < 2) continue;
+        buffer.firsts.push_back((GLint)segment.begin);
+        buffer.counts.push_back((GLsizei)(segment.end - segment.begin));
+    }
+    buffer.revision = func.revision;
+    buffer.uploaded = true;
+}
+
+void CurveRenderer::draw(const vector<FunctionData>& functions) {
+    for (auto& item : buffers) item.second.alive = false;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    for (const auto& func : functions) {
+        Buffer& buffer = buffers[func.id];
+        buffer.alive = true;
+        if (!func.enabled) continue;
+        if (!buffer.uploaded || buffer.revision != func.revision) upload(buffer, func);
+        if (buffer.counts.empty()) continue;
+
+        glColor3f(func.color.x, func.color.y, func.color.z);
+        glLineWidth(func.lineWidth);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+        glVertexPointer(2, GL_FLOAT, 0, nullptr);
+        glMultiDrawArrays(GL_LINE_STRIP, buffer.firsts.data(), buffer.counts.data(), (GLsizei)buffer.counts.size());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glLineWidth(1.0f);
+
+    // Bufory usuniętych funkcji
+    for (auto it = buffers.begin(); it != buffers.end();) {
+        if (it->second.alive) {
+            ++it;
+            continue;
+        }
+        if (it->second.vbo != 0) glDeleteBuffers(1, &it->second.vbo);
+        it = buffers.erase(it);
+    }
+}
+
+void CurveRenderer::release() {
+    for (auto& item : buffers) {
+        if (item.second.vbo != 0) glDeleteBuffers(1, &item.second.vbo);
+    }
+    buffers.clear();
+}
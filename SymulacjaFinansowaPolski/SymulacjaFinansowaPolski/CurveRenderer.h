@@ -0,0 +1,41 @@
+#ifndef CURVERENDERER_H
+#define CURVERENDERER_H
+
+#include <vector>
+#include <unordered_map>
+#include "GLHeaders.h"
+#include "FunctionData.h"
+
+// Rysowanie krzywych z buforów wierzchołków (VBO). Punkty funkcji trafiają
+// do bufora tylko po zmianie (FunctionData::revision), a każda funkcja to
+// kilka wywołań GL niezależnie od liczby punktów: odcinki łamanej rysuje
+// jedno glMultiDrawArrays. Potok stały (glVertexPointer), więc wystarcza
+// kontekst OpenGL 2.1, także programowy llvmpipe z Mesy.
+class CurveRenderer {
+private:
+    struct Buffer {
+        GLuint vbo = 0;
+        size_t capacity = 0;        // w wierzchołkach
+        unsigned revision = 0;
+        bool uploaded = false;
+        bool alive = false;         // funkcja jeszcze istnieje (sprzątanie w draw)
+        std::vector<GLint> firsts;
+        std::vector<GLsizei> counts;
+    };
+
+    std::unordered_map<unsigned, Buffer> buffers;   // klucz: FunctionData::id
+    std::vector<float> staging;                     // x, y na przemian do wysłania
+
+    void upload(Buffer& buffer, const FunctionData& func);
+
+public:
+    CurveRenderer() = default;
+    CurveRenderer(const CurveRenderer&) = delete;
+    CurveRenderer& operator=(const CurveRenderer&) = delete;
+
+    void draw(const std::vector<FunctionData>& functions);
+    // Zwalnia bufory; wołać przy aktywnym kontekście, przed jego zniszczeniem
+    void release();
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "ExpressionCache.h"
+#include <cctype>
+
+using namespace std;
+
+ExpressionCache::ExpressionCache(size_t capacity) : capacity(capacity), hits(0), misses(0) {}
+
+// To samo co removeWhitespace(toLower(...)) na początku setExpression
+static string cacheKey(const string& expression) {
+    string key;
+    key.reserve(expression.size());
+    for (char c : expression) {
+        if (!isspace(static_cast<unsigned char>(c))) key += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+shared_ptr<const MathExpressionParser> ExpressionCache::get(const string& expression) {
+    string key = cacheKey(expression);
+    lock_guard<mutex> lock(accessMutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    misses++;
+    auto parser = make_shared<MathExpressionParser>();
+    parser->setExpression(expression);
+
+    entries.emplace_front(key, parser);
+    index[key] = entries.begin();
+    if (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    return parser;
+}
+
+void ExpressionCache::clear() {
+    lock_guard<mutex> lock(accessMutex);
+    entries.clear();
+    index.clear();
+}
+
+size_t ExpressionCache::size() const { lock_guard<mutex> lock(accessMutex); return entries.size(); }
+size_t ExpressionCache::getHits() const { lock_guard<mutex> lock(accessMutex); return hits; }
+size_t ExpressionCache::getMisses() const { lock_guard<mutex> lock(accessMutex); return misses; }
+
+ExpressionCache& getExpressionCache() {
+    static ExpressionCache cache;
+    return cache;
+}
@@ -0,0 +1,43 @@
+#ifndef EXPRESSIONCACHE_H
+#define EXPRESSIONCACHE_H
+
+#include <string>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "MathExpressionParser.h"
+
+// Wspólna dla całego procesu pamięć skompilowanych wyrażeń (program,
+// drzewo, typ i błąd) z wypieraniem najdawniej używanych (LRU).
+// Kluczem jest tekst po usunięciu spacji i zamianie na małe litery, więc
+// "Y = Sin(x)" i "y=sin(x)" kompilują się raz. Zwracane obiekty są
+// niezmienne i mogą być trzymane dłużej niż wpis w pamięci podręcznej.
+// Błąd parsera dotyczy tekstu, z którego powstał; komunikat dla własnego
+// tekstu daje getErrorMessage(text).
+class ExpressionCache {
+private:
+    typedef std::pair<std::string, std::shared_ptr<const MathExpressionParser>> Entry;
+
+    std::list<Entry> entries;       // od najświeższego
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t capacity;
+    size_t hits, misses;
+    mutable std::mutex accessMutex;
+
+public:
+    static const size_t DEFAULT_CAPACITY = 256;
+
+    explicit ExpressionCache(size_t capacity = DEFAULT_CAPACITY);
+
+    std::shared_ptr<const MathExpressionParser> get(const std::string& expression);
+    void clear();
+
+    size_t size() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+};
+
+ExpressionCache& getExpressionCache();
+
+#endif // EXPRESSIONCACHE_H
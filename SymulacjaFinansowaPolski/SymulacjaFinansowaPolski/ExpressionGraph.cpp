@@ -0,0 +1,100 @@
+#include "ExpressionGraph.h"
+#include "ExpressionOps.h"
+#include <cstring>
+#include <cstdint>
+#include <functional>
+
+using namespace std;
+
+bool GraphNode::operator==(const GraphNode& other) const {
+    // Stałe porównywane bitowo, żeby NAN też się scalał
+    return op == other.op && left == other.left && right == other.right &&
+           memcmp(&value, &other.value, sizeof(value)) == 0;
+}
+
+size_t GraphNodeHash::operator()(const GraphNode& node) const {
+    uint64_t bits;
+    memcpy(&bits, &node.value, sizeof(bits));
+    size_t h = hash<uint64_t>()(bits);
+    h = h * 31 + static_cast<size_t>(node.op);
+    h = h * 31 + static_cast<size_t>(node.left + 1);
+    h = h * 31 + static_cast<size_t>(node.right + 1);
+    return h;
+}
+
+int ExpressionGraph::intern(const GraphNode& node) {
+    auto it = lookup.find(node);
+    if (it != lookup.end()) return it->second;
+    int index = static_cast<int>(nodes.size());
+    nodes.push_back(node);
+    lookup.emplace(node, index);
+    return index;
+}
+
+// Te same formy natychmiastowe co ExpressionProgram::emit, a argumenty
+// + i * w ustalonej kolejności, żeby x*sin(x) i sin(x)*x dały jeden węzeł.
+int ExpressionGraph::insert(const ExpressionNode& node) {
+    if (node.kind == NODE_CONSTANT) return intern({ OP_CONST, node.value, -1, -1 });
+    if (node.kind == NODE_VARIABLE) return intern({ OP_LOAD_X, 0.0, -1, -1 });
+    if (node.isUnary()) return intern({ unaryOpCode(node.kind), 0.0, insert(*node.left), -1 });
+
+    const ExpressionNode& left = *node.left;
+    const ExpressionNode& right = *node.right;
+    OpCode op = binaryOpCode(node.kind);
+
+    if (right.kind == NODE_CONSTANT) {
+        static const OpCode immediate[] = { OP_ADD_CONST, OP_SUB_CONST, OP_MUL_CONST, OP_DIV_CONST, OP_POW_CONST };
+        return intern({ immediate[op - OP_ADD], right.value, insert(left), -1 });
+    }
+    if (left.kind == NODE_CONSTANT && node.kind != NODE_POW) {
+        static const OpCode reversed[] = { OP_ADD_CONST, OP_RSUB_CONST, OP_MUL_CONST, OP_RDIV_CONST };
+        return intern({ reversed[op - OP_ADD], left.value, insert(right), -1 });
+    }
+
+    int a = insert(left);
+    int b = insert(right);
+    if ((op == OP_ADD || op == OP_MUL) && a > b) swap(a, b);
+    return intern({ op, 0.0, a, b });
+}
+
+int ExpressionGraph::add(const ExpressionNode& root) {
+    outputs.push_back(insert(root));
+    return static_cast<int>(outputs.size()) - 1;
+}
+
+void ExpressionGraph::clear() {
+    nodes.clear();
+    lookup.clear();
+    outputs.clear();
+}
+
+size_t ExpressionGraph::size() const { return nodes.size(); }
+size_t ExpressionGraph::outputCount() const { return outputs.size(); }
+
+void ExpressionGraph::evaluate(span<const float> xs, span<float> ys) const {
+    const size_t B = ExpressionProgram::BLOCK_SIZE;
+    const size_t count = xs.size();
+    if (outputs.empty() || ys.size() < outputs.size() * count) return;
+
+    const VectorMathKernels& vm = getVectorMathKernels();
+
+    // Jeden wiersz BLOCK_SIZE wartości na węzeł; bufor rośnie tylko przy pierwszym użyciu
+    thread_local vector<float> rows;
+    if (rows.size() < nodes.size() * B) rows.resize(nodes.size() * B);
+
+    for (size_t start = 0; start < count; start += B) {
+        size_t n = min(B, count - start);
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const GraphNode& node = nodes[i];
+            float* row = rows.data() + i * B;
+            const float* b = nullptr;
+            if (node.left >= 0) copy(rows.data() + node.left * B, rows.data() + node.left * B + n, row);
+            if (node.right >= 0) b = rows.data() + node.right * B;
+            applyBlockOp(vm, node.op, static_cast<float>(node.value), row, b, xs.data() + start, n);
+        }
+        for (size_t k = 0; k < outputs.size(); k++) {
+            const float* row = rows.data() + outputs[k] * B;
+            copy(row, row + n, ys.data() + k * count + start);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef EXPRESSIONGRAPH_H
+#define EXPRESSIONGRAPH_H
+
+#include <vector>
+#include <unordered_map>
+#include <span>
+#include "ExpressionNode.h"
+#include "ExpressionProgram.h"
+
+// Węzeł grafu w postaci rejestrowej: wynik węzła to osobny wiersz próbek,
+// argumenty to indeksy wcześniejszych węzłów (-1 gdy nieużywany).
+struct GraphNode {
+    OpCode op;
+    double value;
+    int left;
+    int right;
+
+    bool operator==(const GraphNode& other) const;
+};
+
+struct GraphNodeHash {
+    size_t operator()(const GraphNode& node) const;
+};
+
+// Wspólny graf (DAG) wyrażeń wielu funkcji. Identyczne poddrzewa są
+// scalane (hash-consing), więc np. sin(x) z sin(x)^2 i 1-sin(x)^2 jest
+// liczony raz na blok próbek i używany przez obie funkcje.
+// Węzły są dodawane po swoich argumentach, więc kolejność w wektorze
+// jest od razu kolejnością obliczeń.
+class ExpressionGraph {
+private:
+    std::vector<GraphNode> nodes;
+    std::unordered_map<GraphNode, int, GraphNodeHash> lookup;
+    std::vector<int> outputs;
+
+    int intern(const GraphNode& node);
+    int insert(const ExpressionNode& node);
+
+public:
+    // Zwraca numer wyjścia dla wyrażenia
+    int add(const ExpressionNode& root);
+    void clear();
+
+    size_t size() const;
+    size_t outputCount() const;
+
+    // ys to outputCount() wierszy po xs.size() wartości: ys[k * xs.size() + i]
+    void evaluate(std::span<const float> xs, std::span<float> ys) const;
+};
+
+#endif // EXPRESSIONGRAPH_H
@@ -0,0 +1,28 @@
+#include "ExpressionNode.h"
+#include <cstdio>
+
+using namespace std;
+
+ExpressionNode::ExpressionNode(NodeKind k, double v) : kind(k), value(v) {}
+
+ExpressionNode::ExpressionNode(NodeKind k, unique_ptr<ExpressionNode> l, unique_ptr<ExpressionNode> r)
+    : kind(k), value(0.0), left(std::move(l)), right(std::move(r)) {}
+
+bool ExpressionNode::isUnary() const {
+    return kind == NODE_NEG || kind == NODE_SIN || kind == NODE_COS || kind == NODE_TAN ||
+           kind == NODE_LN || kind == NODE_LOG || kind == NODE_EXP || kind == NODE_ABS;
+}
+
+string dumpExpression(const ExpressionNode& node) {
+    static const char* names[] = { "", "x", "+", "-", "*", "/", "^", "-", "sin", "cos", "tan", "ln", "log", "exp", "abs" };
+
+    if (node.kind == NODE_CONSTANT) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.9g", node.value);
+        return buffer;
+    }
+    if (node.kind == NODE_VARIABLE) return "x";
+    if (node.kind == NODE_NEG) return "(-" + dumpExpression(*node.left) + ")";
+    if (node.isUnary()) return string(names[node.kind]) + "(" + dumpExpression(*node.left) + ")";
+    return "(" + dumpExpression(*node.left) + " " + names[node.kind] + " " + dumpExpression(*node.right) + ")";
+}
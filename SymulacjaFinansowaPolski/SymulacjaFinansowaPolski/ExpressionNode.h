@@ -0,0 +1,42 @@
+#ifndef EXPRESSIONNODE_H
+#define EXPRESSIONNODE_H
+
+#include <memory>
+#include <string>
+
+enum NodeKind {
+    NODE_CONSTANT,
+    NODE_VARIABLE,
+    NODE_ADD,
+    NODE_SUB,
+    NODE_MUL,
+    NODE_DIV,
+    NODE_POW,
+    NODE_NEG,
+    NODE_SIN,
+    NODE_COS,
+    NODE_TAN,
+    NODE_LN,
+    NODE_LOG,
+    NODE_EXP,
+    NODE_ABS
+};
+
+// Wezel drzewa wyrazenia budowanego raz w setExpression.
+// Operatory jednoargumentowe i funkcje uzywaja tylko 'left'.
+struct ExpressionNode {
+    NodeKind kind;
+    double value;
+    std::unique_ptr<ExpressionNode> left;
+    std::unique_ptr<ExpressionNode> right;
+
+    explicit ExpressionNode(NodeKind k, double v = 0.0);
+    ExpressionNode(NodeKind k, std::unique_ptr<ExpressionNode> l, std::unique_ptr<ExpressionNode> r = nullptr);
+
+    bool isUnary() const;
+};
+
+// Zapis infiksowy z pełnymi nawiasami, np. "((x * 6.28318531) + 12)"
+std::string dumpExpression(const ExpressionNode& node);
+
+#endif // EXPRESSIONNODE_H
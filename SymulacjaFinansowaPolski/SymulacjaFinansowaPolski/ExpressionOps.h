@@ -0,0 +1,121 @@
+#ifndef EXPRESSIONOPS_H
+#define EXPRESSIONOPS_H
+
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include "ExpressionProgram.h"
+#include "VectorMath.h"
+
+// Reguły dziedziny i pętle po bloku próbek wspólne dla ExpressionProgram
+// (maszyna stosowa) i ExpressionGraph (wspólne podwyrażenia wielu funkcji).
+
+template <typename T>
+inline T safeDiv(T num, T den) {
+    if (std::fabs(den) < T(0.000001)) return NAN;
+    return num / den;
+}
+
+template <typename T>
+inline T safePow(T base, T exponent) {
+    if (base < 0 && std::fabs(exponent - std::round(exponent)) > T(0.0001)) return NAN;
+    return std::pow(base, exponent);
+}
+
+// Stały wykładnik całkowity |n| <= 64: podnoszenie do kwadratu, jak w kernelPowConst
+template <typename T>
+inline bool isSmallInteger(T exponent) {
+    return exponent == std::round(exponent) && std::fabs(exponent) <= T(64);
+}
+
+template <typename T>
+inline T powInt(T base, T exponent) {
+    T result = 1;
+    for (int k = static_cast<int>(std::fabs(exponent)); k > 0; k >>= 1) {
+        if (k & 1) result *= base;
+        base *= base;
+    }
+    return (exponent < 0) ? safeDiv(T(1), result) : result;
+}
+
+// |tan| > 1e4 odpowiada |cos| < 1e-4, tak samo liczą to jądra VectorMath
+template <typename T>
+inline T safeTan(T value) {
+    T result = std::tan(value);
+    if (std::fabs(result) > T(10000)) return NAN;
+    return result;
+}
+
+template <typename T>
+inline T safeLn(T value) {
+    return (value <= 0) ? T(NAN) : std::log(value);
+}
+
+template <typename T>
+inline T safeLog10(T value) {
+    return (value <= 0) ? T(NAN) : std::log10(value);
+}
+
+inline bool isBinaryOp(OpCode op) {
+    return op >= OP_ADD && op <= OP_POW;
+}
+
+// Jedna instrukcja na n próbkach: a = a op b dla operacji dwuargumentowych,
+// a = f(a) dla pozostałych, a = c / a = xs dla OP_CONST / OP_LOAD_X.
+// Dla float operacje idą przez jądra SIMD z VectorMath, dla double przez <cmath>.
+template <typename T>
+void applyBlockOp(const VectorMathKernels& vm, OpCode op, T c, T* a, const T* b, const T* xs, size_t n) {
+    constexpr bool simd = std::is_same<T, float>::value;
+    switch (op) {
+        case OP_CONST: std::fill(a, a + n, c); break;
+        case OP_LOAD_X: std::copy(xs, xs + n, a); break;
+        case OP_ADD:
+            if constexpr (simd) vm.add(a, b, n); else for (size_t i = 0; i < n; i++) a[i] += b[i];
+            break;
+        case OP_SUB:
+            if constexpr (simd) vm.sub(a, b, n); else for (size_t i = 0; i < n; i++) a[i] -= b[i];
+            break;
+        case OP_MUL:
+            if constexpr (simd) vm.mul(a, b, n); else for (size_t i = 0; i < n; i++) a[i] *= b[i];
+            break;
+        case OP_DIV:
+            if constexpr (simd) vm.div(a, b, n); else for (size_t i = 0; i < n; i++) a[i] = safeDiv(a[i], b[i]);
+            break;
+        case OP_POW:
+            if constexpr (simd) vm.pow(a, b, n); else for (size_t i = 0; i < n; i++) a[i] = safePow(a[i], b[i]);
+            break;
+        case OP_ADD_CONST: for (size_t i = 0; i < n; i++) a[i] += c; break;
+        case OP_SUB_CONST: for (size_t i = 0; i < n; i++) a[i] -= c; break;
+        case OP_RSUB_CONST: for (size_t i = 0; i < n; i++) a[i] = c - a[i]; break;
+        case OP_MUL_CONST: for (size_t i = 0; i < n; i++) a[i] *= c; break;
+        case OP_DIV_CONST: for (size_t i = 0; i < n; i++) a[i] = safeDiv(a[i], c); break;
+        case OP_RDIV_CONST: for (size_t i = 0; i < n; i++) a[i] = safeDiv(c, a[i]); break;
+        case OP_POW_CONST:
+            if constexpr (simd) vm.powConst(a, c, n);
+            else if (isSmallInteger(c)) for (size_t i = 0; i < n; i++) a[i] = powInt(a[i], c);
+            else for (size_t i = 0; i < n; i++) a[i] = safePow(a[i], c);
+            break;
+        case OP_NEG: for (size_t i = 0; i < n; i++) a[i] = -a[i]; break;
+        case OP_SIN:
+            if constexpr (simd) vm.sin(a, n); else for (size_t i = 0; i < n; i++) a[i] = std::sin(a[i]);
+            break;
+        case OP_COS:
+            if constexpr (simd) vm.cos(a, n); else for (size_t i = 0; i < n; i++) a[i] = std::cos(a[i]);
+            break;
+        case OP_TAN:
+            if constexpr (simd) vm.tan(a, n); else for (size_t i = 0; i < n; i++) a[i] = safeTan(a[i]);
+            break;
+        case OP_LN:
+            if constexpr (simd) vm.ln(a, n); else for (size_t i = 0; i < n; i++) a[i] = safeLn(a[i]);
+            break;
+        case OP_LOG:
+            if constexpr (simd) vm.log10(a, n); else for (size_t i = 0; i < n; i++) a[i] = safeLog10(a[i]);
+            break;
+        case OP_EXP:
+            if constexpr (simd) vm.exp(a, n); else for (size_t i = 0; i < n; i++) a[i] = std::exp(a[i]);
+            break;
+        case OP_ABS: for (size_t i = 0; i < n; i++) a[i] = std::fabs(a[i]); break;
+    }
+}
+
+#endif // EXPRESSIONOPS_H
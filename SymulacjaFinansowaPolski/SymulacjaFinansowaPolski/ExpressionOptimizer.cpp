@@ -0,0 +1,124 @@
+#include "ExpressionOptimizer.h"
+#include "ExpressionProgram.h"
+#include <cmath>
+
+using namespace std;
+
+static bool isConstant(const ExpressionNode& node, double value) {
+    return node.kind == NODE_CONSTANT && node.value == value;
+}
+
+static unique_ptr<ExpressionNode> makeConstant(double value) {
+    return make_unique<ExpressionNode>(NODE_CONSTANT, value);
+}
+
+// Węzeł o stałych argumentach liczony tym samym programem co przy próbkowaniu,
+// więc np. ln(-1) albo 1/0 dają NAN tak samo jak przed zwinięciem.
+static double evaluateConstant(const ExpressionNode& node) {
+    ExpressionProgram program;
+    program.compile(node);
+    double x = 0.0, y = NAN;
+    program.run(&x, &y, 1);
+    return y;
+}
+
+static unique_ptr<ExpressionNode> simplify(unique_ptr<ExpressionNode> node);
+
+static unique_ptr<ExpressionNode> simplifyAdd(unique_ptr<ExpressionNode> node) {
+    // Stała zawsze po prawej, żeby łańcuchy (e + c1) + c2 dało się łączyć
+    if (node->left->kind == NODE_CONSTANT) swap(node->left, node->right);
+    ExpressionNode& left = *node->left;
+    ExpressionNode& right = *node->right;
+
+    if (right.kind != NODE_CONSTANT) return node;
+    if (right.value == 0.0) return std::move(node->left);
+    if (left.kind == NODE_ADD && left.right->kind == NODE_CONSTANT) {
+        left.right->value += right.value;
+        return simplify(std::move(node->left));
+    }
+    return node;
+}
+
+static unique_ptr<ExpressionNode> simplifyMul(unique_ptr<ExpressionNode> node) {
+    if (node->left->kind == NODE_CONSTANT) swap(node->left, node->right);
+    ExpressionNode& left = *node->left;
+    ExpressionNode& right = *node->right;
+
+    if (right.kind != NODE_CONSTANT) return node;
+    if (right.value == 1.0) return std::move(node->left);
+    if (right.value == -1.0) return simplify(make_unique<ExpressionNode>(NODE_NEG, std::move(node->left)));
+    if (left.kind == NODE_MUL && left.right->kind == NODE_CONSTANT) {
+        left.right->value *= right.value;
+        return simplify(std::move(node->left));
+    }
+    if (left.kind == NODE_NEG) {
+        right.value = -right.value;
+        node->left = std::move(left.left);
+        return simplify(std::move(node));
+    }
+    return node;
+}
+
+static unique_ptr<ExpressionNode> simplify(unique_ptr<ExpressionNode> node) {
+    if (node->kind == NODE_CONSTANT || node->kind == NODE_VARIABLE) return node;
+
+    bool constantArguments = node->left->kind == NODE_CONSTANT &&
+                             (!node->right || node->right->kind == NODE_CONSTANT);
+    if (constantArguments) return makeConstant(evaluateConstant(*node));
+
+    switch (node->kind) {
+        case NODE_ADD:
+            return simplifyAdd(std::move(node));
+        case NODE_SUB:
+            if (isConstant(*node->right, 0.0)) return std::move(node->left);
+            if (isConstant(*node->left, 0.0)) {
+                return simplify(make_unique<ExpressionNode>(NODE_NEG, std::move(node->right)));
+            }
+            if (node->right->kind == NODE_CONSTANT) {
+                node->kind = NODE_ADD;
+                node->right->value = -node->right->value;
+                return simplifyAdd(std::move(node));
+            }
+            return node;
+        case NODE_MUL:
+            return simplifyMul(std::move(node));
+        case NODE_DIV:
+            if (isConstant(*node->right, 1.0)) return std::move(node->left);
+            // Stała >= 1e-6 nigdy nie daje NAN w safeDiv, więc można mnożyć
+            if (node->right->kind == NODE_CONSTANT && fabs(node->right->value) >= 0.000001) {
+                node->kind = NODE_MUL;
+                node->right->value = 1.0 / node->right->value;
+                return simplifyMul(std::move(node));
+            }
+            return node;
+        case NODE_POW:
+            if (isConstant(*node->right, 1.0)) return std::move(node->left);
+            if (isConstant(*node->right, 0.0)) return makeConstant(1.0);
+            if (node->left->kind == NODE_VARIABLE &&
+                (isConstant(*node->right, 2.0) || isConstant(*node->right, 3.0))) {
+                unique_ptr<ExpressionNode> chain = make_unique<ExpressionNode>(NODE_MUL,
+                    make_unique<ExpressionNode>(NODE_VARIABLE), make_unique<ExpressionNode>(NODE_VARIABLE));
+                if (node->right->value == 3.0) {
+                    chain = make_unique<ExpressionNode>(NODE_MUL, std::move(chain), make_unique<ExpressionNode>(NODE_VARIABLE));
+                }
+                return chain;
+            }
+            return node;
+        case NODE_NEG:
+            if (node->left->kind == NODE_NEG) return std::move(node->left->left);
+            if (node->left->kind == NODE_MUL && node->left->right->kind == NODE_CONSTANT) {
+                node->left->right->value = -node->left->right->value;
+                return simplifyMul(std::move(node->left));
+            }
+            return node;
+        default:
+            return node;
+    }
+}
+
+unique_ptr<ExpressionNode> optimizeExpression(unique_ptr<ExpressionNode> node) {
+    if (!node) return node;
+    if (node->left) node->left = optimizeExpression(std::move(node->left));
+    if (node->right) node->right = optimizeExpression(std::move(node->right));
+    return simplify(std::move(node));
+}
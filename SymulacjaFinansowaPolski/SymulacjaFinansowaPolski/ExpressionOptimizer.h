@@ -0,0 +1,18 @@
+#ifndef EXPRESSIONOPTIMIZER_H
+#define EXPRESSIONOPTIMIZER_H
+
+#include <memory>
+#include "ExpressionNode.h"
+
+// Upraszczanie drzewa przed kompilacją do ExpressionProgram:
+//   - poddrzewa bez x są liczone raz (2*pi*x+3*4 -> x*6.28319+12),
+//   - stałe w łańcuchach + i * są łączone (2*x*3 -> x*6), dzielenie przez
+//     stałą staje się mnożeniem przez odwrotność,
+//   - tożsamości x*1, x+0, x-0, x/1, x^1, x^0, --x,
+//   - x^2 i x^3 -> x*x, x*x*x; pozostałe całkowite potęgi liczy OP_POW_CONST
+//     przez podnoszenie do kwadratu.
+// Wynik ma te same reguły dziedziny (NAN) co drzewo wejściowe; różnice to
+// wyłącznie zaokrąglenia stałych, liczonych raz w double.
+std::unique_ptr<ExpressionNode> optimizeExpression(std::unique_ptr<ExpressionNode> node);
+
+#endif // EXPRESSIONOPTIMIZER_H
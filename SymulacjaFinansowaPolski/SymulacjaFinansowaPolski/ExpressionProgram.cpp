@@ -0,0 +1,233 @@
+#include "ExpressionProgram.h"
+#include "ExpressionOps.h"
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <cstdio>
+
+using namespace std;
+
+ExpressionProgram::ExpressionProgram() : stackDepth(0) {}
+
+OpCode binaryOpCode(NodeKind kind) {
+    switch (kind) {
+        case NODE_ADD: return OP_ADD;
+        case NODE_SUB: return OP_SUB;
+        case NODE_MUL: return OP_MUL;
+        case NODE_DIV: return OP_DIV;
+        default: return OP_POW;
+    }
+}
+
+OpCode unaryOpCode(NodeKind kind) {
+    switch (kind) {
+        case NODE_NEG: return OP_NEG;
+        case NODE_SIN: return OP_SIN;
+        case NODE_COS: return OP_COS;
+        case NODE_TAN: return OP_TAN;
+        case NODE_LN: return OP_LN;
+        case NODE_LOG: return OP_LOG;
+        case NODE_EXP: return OP_EXP;
+        default: return OP_ABS;
+    }
+}
+
+// Zwraca glebokosc stosu potrzebna do policzenia poddrzewa.
+int ExpressionProgram::emit(const ExpressionNode& node) {
+    if (node.kind == NODE_CONSTANT) {
+        code.push_back({ OP_CONST, node.value });
+        return 1;
+    }
+    if (node.kind == NODE_VARIABLE) {
+        code.push_back({ OP_LOAD_X, 0.0 });
+        return 1;
+    }
+    if (node.isUnary()) {
+        int depth = emit(*node.left);
+        code.push_back({ unaryOpCode(node.kind), 0.0 });
+        return depth;
+    }
+
+    const ExpressionNode& left = *node.left;
+    const ExpressionNode& right = *node.right;
+
+    // Stala po prawej stronie trafia do instrukcji jako argument natychmiastowy
+    if (right.kind == NODE_CONSTANT) {
+        static const OpCode immediate[] = { OP_ADD_CONST, OP_SUB_CONST, OP_MUL_CONST, OP_DIV_CONST, OP_POW_CONST };
+        int depth = emit(left);
+        code.push_back({ immediate[binaryOpCode(node.kind) - OP_ADD], right.value });
+        return depth;
+    }
+    if (left.kind == NODE_CONSTANT && node.kind != NODE_POW) {
+        static const OpCode reversed[] = { OP_ADD_CONST, OP_RSUB_CONST, OP_MUL_CONST, OP_RDIV_CONST };
+        int depth = emit(right);
+        code.push_back({ reversed[binaryOpCode(node.kind) - OP_ADD], left.value });
+        return depth;
+    }
+
+    int leftDepth = emit(left);
+    int rightDepth = emit(right);
+    code.push_back({ binaryOpCode(node.kind), 0.0 });
+    return max(leftDepth, rightDepth + 1);
+}
+
+bool ExpressionProgram::compile(const ExpressionNode& root) {
+    clear();
+    stackDepth = emit(root);
+    if (stackDepth > MAX_STACK_DEPTH) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void ExpressionProgram::setPolynomial(const vector<double>& coefficients) {
+    polynomialDouble = coefficients;
+    polynomial.assign(coefficients.begin(), coefficients.end());
+}
+
+void ExpressionProgram::clear() {
+    code.clear();
+    stackDepth = 0;
+    polynomial.clear();
+    polynomialDouble.clear();
+}
+
+// Bledy dziedziny (ln(<=0), dzielenie przez zero, asymptota tangensa)
+// daja NAN, ktore propaguje sie do wyniku.
+float ExpressionProgram::run(float x) const {
+    if (!polynomial.empty()) {
+        float result = polynomial.back();
+        for (size_t k = polynomial.size() - 1; k-- > 0;) result = result * x + polynomial[k];
+        return result;
+    }
+    if (code.empty()) return NAN;
+
+    float stack[MAX_STACK_DEPTH];
+    int top = -1;
+
+    for (const Instruction& ins : code) {
+        float c = static_cast<float>(ins.value);
+        switch (ins.op) {
+            case OP_CONST: stack[++top] = c; break;
+            case OP_LOAD_X: stack[++top] = x; break;
+            case OP_ADD: top--; stack[top] += stack[top + 1]; break;
+            case OP_SUB: top--; stack[top] -= stack[top + 1]; break;
+            case OP_MUL: top--; stack[top] *= stack[top + 1]; break;
+            case OP_DIV: top--; stack[top] = safeDiv(stack[top], stack[top + 1]); break;
+            case OP_POW: top--; stack[top] = safePow(stack[top], stack[top + 1]); break;
+            case OP_ADD_CONST: stack[top] += c; break;
+            case OP_SUB_CONST: stack[top] -= c; break;
+            case OP_RSUB_CONST: stack[top] = c - stack[top]; break;
+            case OP_MUL_CONST: stack[top] *= c; break;
+            case OP_DIV_CONST: stack[top] = safeDiv(stack[top], c); break;
+            case OP_RDIV_CONST: stack[top] = safeDiv(c, stack[top]); break;
+            case OP_POW_CONST: stack[top] = isSmallInteger(c) ? powInt(stack[top], c) : safePow(stack[top], c); break;
+            case OP_NEG: stack[top] = -stack[top]; break;
+            case OP_SIN: stack[top] = sin(stack[top]); break;
+            case OP_COS: stack[top] = cos(stack[top]); break;
+            case OP_TAN: stack[top] = safeTan(stack[top]); break;
+            case OP_LN: stack[top] = safeLn(stack[top]); break;
+            case OP_LOG: stack[top] = safeLog10(stack[top]); break;
+            case OP_EXP: stack[top] = exp(stack[top]); break;
+            case OP_ABS: stack[top] = fabs(stack[top]); break;
+        }
+    }
+    return stack[top];
+}
+
+// Jeden blok: stos sklada sie z wierszy po BLOCK_SIZE wartosci,
+// kazda instrukcja to jedna petla po wszystkich probkach bloku (applyBlockOp).
+template <typename T>
+static void runBlock(const vector<Instruction>& code, const T* xs, T* ys, size_t n, T* stack) {
+    const VectorMathKernels& vm = getVectorMathKernels();
+    const size_t B = ExpressionProgram::BLOCK_SIZE;
+    size_t depth = 0;
+
+    for (const Instruction& ins : code) {
+        T c = static_cast<T>(ins.value);
+        if (ins.op == OP_CONST || ins.op == OP_LOAD_X) {
+            applyBlockOp(vm, ins.op, c, stack + depth * B, static_cast<const T*>(nullptr), xs, n);
+            depth++;
+        } else if (isBinaryOp(ins.op)) {
+            T* a = stack + (depth - 2) * B;
+            applyBlockOp(vm, ins.op, c, a, a + B, xs, n);
+            depth--;
+        } else {
+            applyBlockOp(vm, ins.op, c, stack + (depth - 1) * B, static_cast<const T*>(nullptr), xs, n);
+        }
+    }
+    copy(stack, stack + n, ys);
+}
+
+template <typename T>
+static void runBatch(const vector<Instruction>& code, int depth, const T* xs, T* ys, size_t count) {
+    if (code.empty()) {
+        fill(ys, ys + count, T(NAN));
+        return;
+    }
+
+    // Bufor stosu jest wspolny dla watku i rosnie tylko przy pierwszym uzyciu
+    thread_local vector<T> stack;
+    size_t needed = static_cast<size_t>(depth) * ExpressionProgram::BLOCK_SIZE;
+    if (stack.size() < needed) stack.resize(needed);
+
+    for (size_t start = 0; start < count; start += ExpressionProgram::BLOCK_SIZE) {
+        size_t n = min(ExpressionProgram::BLOCK_SIZE, count - start);
+        runBlock(code, xs + start, ys + start, n, stack.data());
+    }
+}
+
+void ExpressionProgram::run(const float* xs, float* ys, size_t count) const {
+    if (!polynomial.empty()) {
+        getVectorMathKernels().polynomial(polynomial.data(), polynomial.size() - 1, xs, ys, count);
+        return;
+    }
+    runBatch(code, stackDepth, xs, ys, count);
+}
+
+void ExpressionProgram::run(const double* xs, double* ys, size_t count) const {
+    if (!polynomialDouble.empty()) {
+        size_t degree = polynomialDouble.size() - 1;
+        for (size_t i = 0; i < count; i++) {
+            double result = polynomialDouble[degree];
+            for (size_t k = degree; k-- > 0;) result = result * xs[i] + polynomialDouble[k];
+            ys[i] = result;
+        }
+        return;
+    }
+    runBatch(code, stackDepth, xs, ys, count);
+}
+
+bool ExpressionProgram::empty() const { return code.empty(); }
+bool ExpressionProgram::isPolynomial() const { return !polynomial.empty(); }
+const vector<double>& ExpressionProgram::getPolynomial() const { return polynomialDouble; }
+size_t ExpressionProgram::size() const { return code.size(); }
+int ExpressionProgram::getStackDepth() const { return stackDepth; }
+const vector<Instruction>& ExpressionProgram::getCode() const { return code; }
+
+string ExpressionProgram::dump() const {
+    static const char* names[] = {
+        "CONST", "LOAD_X", "ADD", "SUB", "MUL", "DIV", "POW",
+        "ADD_CONST", "SUB_CONST", "RSUB_CONST", "MUL_CONST", "DIV_CONST", "RDIV_CONST", "POW_CONST",
+        "NEG", "SIN", "COS", "TAN", "LN", "LOG", "EXP", "ABS"
+    };
+
+    string result;
+    char buffer[64];
+    if (!polynomialDouble.empty()) {
+        result = "HORNER";
+        for (double c : polynomialDouble) {
+            snprintf(buffer, sizeof(buffer), " %.9g", c);
+            result += buffer;
+        }
+        return result + "\n";
+    }
+    for (const Instruction& ins : code) {
+        bool immediate = ins.op == OP_CONST || (ins.op >= OP_ADD_CONST && ins.op <= OP_POW_CONST);
+        if (immediate) snprintf(buffer, sizeof(buffer), "%s %.9g\n", names[ins.op], ins.value);
+        else snprintf(buffer, sizeof(buffer), "%s\n", names[ins.op]);
+        result += buffer;
+    }
+    return result;
+}
@@ -0,0 +1,84 @@
+#ifndef EXPRESSIONPROGRAM_H
+#define EXPRESSIONPROGRAM_H
+
+#include <vector>
+#include <string>
+#include "ExpressionNode.h"
+
+enum OpCode {
+    OP_CONST,
+    OP_LOAD_X,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_ADD_CONST,
+    OP_SUB_CONST,
+    OP_RSUB_CONST,
+    OP_MUL_CONST,
+    OP_DIV_CONST,
+    OP_RDIV_CONST,
+    OP_POW_CONST,
+    OP_NEG,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_LN,
+    OP_LOG,
+    OP_EXP,
+    OP_ABS
+};
+
+OpCode binaryOpCode(NodeKind kind);
+OpCode unaryOpCode(NodeKind kind);
+
+// Instrukcja maszyny stosowej; stala jest zapisana bezposrednio w instrukcji
+// (OP_CONST i warianty *_CONST), wiec program nie odwoluje sie do drzewa.
+struct Instruction {
+    OpCode op;
+    double value;
+};
+
+// Plaski program w odwrotnej notacji polskiej. Kopiowanie to kopia jednego
+// wektora, wiec kazda funkcja moze trzymac wlasny egzemplarz.
+// Wersja wsadowa wykonuje kazda instrukcje na calym bloku BLOCK_SIZE probek,
+// zanim przejdzie do nastepnej, wiec koszt interpretacji placi sie raz na blok.
+//
+// Wielomian o znanych współczynnikach (setPolynomial) liczony jest schematem
+// Hornera z pominięciem interpretera; kod instrukcji zostaje tylko do podglądu.
+class ExpressionProgram {
+private:
+    std::vector<Instruction> code;
+    int stackDepth;
+    std::vector<float> polynomial;          // współczynniki, indeks = wykładnik
+    std::vector<double> polynomialDouble;
+
+    int emit(const ExpressionNode& node);
+
+public:
+    static constexpr int MAX_STACK_DEPTH = 64;
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    ExpressionProgram();
+
+    bool compile(const ExpressionNode& root);
+    void setPolynomial(const std::vector<double>& coefficients);
+    void clear();
+
+    float run(float x) const;
+    void run(const float* xs, float* ys, size_t count) const;
+    void run(const double* xs, double* ys, size_t count) const;
+
+    bool empty() const;
+    bool isPolynomial() const;
+    const std::vector<double>& getPolynomial() const;
+    size_t size() const;
+    int getStackDepth() const;
+    const std::vector<Instruction>& getCode() const;
+
+    // Lista instrukcji (albo współczynników Hornera), po jednej w wierszu
+    std::string dump() const;
+};
+
+#endif // EXPRESSIONPROGRAM_H
@@ -1,7 +1,7 @@
 #include "FunctionData.h"
 
 FunctionData::FunctionData(const std::string& expr, const ImVec4& col)
-    : expression(expr), color(col), enabled(true), editing(false), editBuffer(expr) {}
+    : expression(expr), revision(0), id(0), color(col), lineWidth(2.0f), enabled(true), dirty(true), editing(false), editBuffer(expr), validated(false) {}
 
 void FunctionData::startEditing() {
     editing = true;
@@ -17,4 +17,19 @@ void FunctionData::applyEdit() {
 
 void FunctionData::cancelEdit() {
     editing = false;
-}
\ No newline at end of file
+}
+
+// Walidacja na żywo pod polem edycji: wynik jest pamiętany dla tekstu,
+// więc kolejne klatki bez zmiany editBuffer nie parsują go ponownie.
+// Poza ExpressionCache, żeby każdy wpisany znak nie wypierał z niej
+// wyrażeń z wykresu.
+const std::string& FunctionData::validateEdit() {
+    if (!validated || validatedBuffer != editBuffer) {
+        MathExpressionParser live;
+        live.setExpression(editBuffer);
+        editError = live.hasError() ? live.getErrorMessage() : std::string();
+        validatedBuffer = editBuffer;
+        validated = true;
+    }
+    return editError;
+}
@@ -3,21 +3,33 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include "imgui.h"
-#include "Point.h"
+#include "Polyline.h"
+#include "MathExpressionParser.h"
 
 struct FunctionData {
     std::string expression;
-    std::vector<Point> points;
+    Polyline curve;         // pełna; podmieniana przez MultiFunctionPlotter::pollResults
+    Polyline rendered;      // curve przycięta do widoku i po redukcji M4; tę rysujemy
+    unsigned revision;      // zwiększany przy każdej podmianie rendered
+    std::shared_ptr<const MathExpressionParser> parser;     // z ExpressionCache
+    unsigned id;            // stały identyfikator nadawany przez ploter
     ImVec4 color;
-    bool enabled;
+    float lineWidth;        // w pikselach bufora ramki
+    bool enabled;           // zmieniać przez MultiFunctionPlotter::setFunctionEnabled
+    bool dirty;             // curve nie odpowiada wyrażeniu, zakresowi lub rozdzielczości
     bool editing;
     std::string editBuffer;
+    std::string validatedBuffer;    // editBuffer z ostatniej walidacji
+    std::string editError;          // jej komunikat błędu, pusty gdy poprawne
+    bool validated;
 
     FunctionData(const std::string& expr, const ImVec4& col);
     void startEditing();
     void applyEdit();
     void cancelEdit();
+    const std::string& validateEdit();  // parsuje editBuffer tylko po jego zmianie
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,483 @@
+#include "FunctionSampler.h"
+#include "TaskScheduler.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+SamplingJob::SamplingJob() : version(0), xMin(-10.0f), xMax(10.0f), pixelWidth(1400), pixelHeight(900),
+                             yMin(-10.0f), yMax(10.0f), clipXMin(-30.0f), clipXMax(30.0f),
+                             clipYMin(-30.0f), clipYMax(30.0f), samplesPerPixel(1.0f), tolerancePixels(0.5f),
+                             tileCacheCapacity(SampleTileCache::DEFAULT_CAPACITY) {}
+
+SamplingResult::SamplingResult() : version(0), evaluations(0) {}
+
+FunctionSampler::FunctionSampler() : xMin(-10.0f), xMax(10.0f), pixelWidth(1400), pixelHeight(900),
+                                     yMin(-10.0f), yMax(10.0f), clipXMin(-30.0f), clipXMax(30.0f),
+                                     clipYMin(-30.0f), clipYMax(30.0f), samplesPerPixel(1.0f), tolerancePixels(0.5f),
+                                     evaluations(0), taskCount(0), viewNodes(0) {
+    updateSampleBudget();
+}
+
+void FunctionSampler::clear() {
+    entries.clear();
+    active.clear();
+    graph.clear();
+    graphParsers.clear();
+}
+
+// Przejmuje widok i funkcje zlecenia. Kafelki funkcji spoza liveIds są
+// usuwane, kafelki funkcji pominiętych w zleceniu zostają; zmiana wyrażenia albo tolerancji i gęstości unieważnia kafelki.
+void FunctionSampler::prepare(const SamplingJob& job) {
+    if (job.samplesPerPixel != samplesPerPixel || job.tolerancePixels != tolerancePixels) {
+        for (auto& item : entries) item.second.tiles.clear();
+        samplesPerPixel = job.samplesPerPixel;
+        tolerancePixels = job.tolerancePixels;
+    }
+    xMin = job.xMin;
+    xMax = job.xMax;
+    pixelWidth = max(job.pixelWidth, 1);
+    pixelHeight = max(job.pixelHeight, 1);
+    yMin = job.yMin;
+    yMax = job.yMax;
+    clipXMin = job.clipXMin;
+    clipXMax = job.clipXMax;
+    clipYMin = job.clipYMin;
+    clipYMax = job.clipYMax;
+    updateSampleBudget();
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (find(job.liveIds.begin(), job.liveIds.end(), it->first) == job.liveIds.end()) it = entries.erase(it);
+        else ++it;
+    }
+
+    // Graf jest aktualny tylko przy tych samych parach (id, parser) na tych
+    // samych miejscach: np. po edycji B na wyrażenie A i dodaniu C z dawnym
+    // wyrażeniem B same parsery się zgadzają, ale wyjścia należą do innych funkcji
+    bool graphChanged = job.parsers.size() != graphParsers.size();
+    active.clear();
+    for (size_t i = 0; i < job.ids.size(); i++) {
+        Entry& entry = entries[job.ids[i]];
+        if (entry.parser != job.parsers[i]) {
+            entry.parser = job.parsers[i];
+            entry.tiles.clear();
+            entry.graphOutput = -1;
+            graphChanged = true;
+        }
+        entry.tiles.setCapacity(job.tileCacheCapacity);
+        active.push_back(&entry);
+        if (!graphChanged && graphParsers[i] != make_pair(job.ids[i], job.parsers[i].get())) graphChanged = true;
+    }
+    if (graphChanged) rebuildGraph(job.ids);
+}
+
+// Wspólny graf dla funkcji liczonych interpreterem; wielomiany (Horner),
+// linie, okręgi i wyrażenia z błędem zostają liczone osobno.
+void FunctionSampler::rebuildGraph(const vector<unsigned>& ids) {
+    graph.clear();
+    graphParsers.clear();
+    for (size_t i = 0; i < active.size(); i++) {
+        Entry* entry = active[i];
+        entry->graphOutput = -1;
+        graphParsers.emplace_back(ids[i], entry->parser.get());
+        if (!entry->parser) continue;
+        const MathExpressionParser& parser = *entry->parser;
+        shared_ptr<const ExpressionNode> tree = parser.getTree();
+        if (!tree || parser.getProgram().isPolynomial() || parser.getType() == HORIZONTAL_LINE) continue;
+        entry->graphOutput = graph.add(*tree);
+    }
+}
+
+// Przebieg w czterech krokach: wyszukanie brakujących kafelków (po kolei),
+// węzły grafu i zagęszczanie kawałków (równolegle), wstawienie kafelków do
+// pamięci funkcji w stałej kolejności zadań i złożenie punktów z redukcją
+// do kolumn pikseli (równolegle, każda funkcja osobno).
+void FunctionSampler::run(const SamplingJob& job, SamplingResult& result) {
+    prepare(job);
+    evaluations = 0;
+    result.version = job.version;
+    result.ids = job.ids;
+    result.curves.resize(active.size());
+    result.rendered.resize(active.size());
+
+    viewNodes = (size_t)(endCell - firstCell + 1);
+    taskCount = 0;
+    graphMissing.assign(endCell - firstCell, 0);
+    adaptive.assign(active.size(), 0);
+
+    for (size_t i = 0; i < active.size(); i++) {
+        Entry& entry = *active[i];
+        Polyline& out = result.curves[i];
+        out.clear();
+        if (entry.graphOutput < 0) {
+            if (!entry.parser) continue;
+            const MathExpressionParser& parser = *entry.parser;
+            if (parser.hasError() && parser.getType() == UNKNOWN) continue;
+            if (sampleSpecial(parser, out)) continue;
+        }
+        adaptive[i] = 1;
+        addTasks(entry, entry.graphOutput >= 0);
+    }
+
+    // Węzły brakujących kafelków funkcji z grafu liczone razem (wspólne
+    // podwyrażenia), w kawałkach po CHUNK_TILES
+    graphChunks.clear();
+    for (long long k = firstCell; k < endCell;) {
+        if (!graphMissing[k - firstCell]) { k++; continue; }
+        long long first = k;
+        while (k < endCell && graphMissing[k - firstCell] && k - first < CHUNK_TILES) k++;
+        if (!graphChunks.empty() && graphChunks.back().last == first) graphChunks.back().sharedLast = true;
+        graphChunks.push_back({ first, k, false });
+        evaluations += graph.outputCount() * (size_t)(k - first + 1);
+    }
+    if (!graphChunks.empty()) {
+        graphY.resize(graph.outputCount() * viewNodes);
+        getTaskScheduler().parallelFor(graphChunks.size(), [this](size_t i) { evaluateGraphChunk(graphChunks[i]); });
+    }
+
+    getTaskScheduler().parallelFor(taskCount, [this](size_t i) { runTask(tasks[i]); });
+
+    for (size_t t = 0; t < taskCount; t++) {
+        SampleTask& task = tasks[t];
+        for (size_t j = 0; j < task.tiles.size(); j++) {
+            task.entry->tiles.insert(gridLevel, task.first + (long long)j, std::move(task.tiles[j]));
+        }
+        evaluations += task.evaluations;
+    }
+
+    getTaskScheduler().parallelFor(active.size(), [this, &result](size_t i) {
+        if (adaptive[i]) assemblePoints(*active[i], result.curves[i]);
+        prepareRenderCurve(result.curves[i], result.rendered[i]);
+    });
+    result.evaluations = evaluations;
+}
+
+// Funkcje, które nie potrzebują próbkowania adaptacyjnego
+bool FunctionSampler::sampleSpecial(const MathExpressionParser& parser, Polyline& out) {
+    // Linie pionowe
+    if (parser.getType() == VERTICAL_LINE) {
+        float xValue = parser.getVerticalLineX();
+        if (!isnan(xValue)) {
+            out.append(xValue, -1000.0f);
+            out.append(xValue, 1000.0f);
+        }
+        return true;
+    }
+
+    // Linie poziome
+    if (parser.getType() == HORIZONTAL_LINE) {
+        float yValue = parser.getHorizontalLineY();
+        if (!isnan(yValue)) {
+            out.append(xMin, yValue);
+            out.append(xMax, yValue);
+        }
+        return true;
+    }
+
+    // Okręgi
+    if (parser.isCircleEquation()) {
+        float cx, cy, r;
+        parser.getCircleParams(cx, cy, r);
+        int circlePoints = 360;
+        for (int i = 0; i <= circlePoints; i++) {
+            float angle = 2.0f * (float)M_PI * i / (float)circlePoints;
+            out.append(cx + r * cos(angle), cy + r * sin(angle));
+        }
+        return true;
+    }
+
+    // Prosta: dwa punkty wystarczą
+    const ExpressionProgram& program = parser.getProgram();
+    if (program.isPolynomial() && program.getPolynomial().size() <= 2) {
+        out.append(xMin, parser.evaluate(xMin));
+        out.append(xMax, parser.evaluate(xMax));
+        evaluations += 2;
+        return true;
+    }
+    return false;
+}
+
+// Budżet próbek wynika z szerokości bufora ramki: widok dzielimy na około
+// pixelWidth * samplesPerPixel / 2^COARSE_LEVELS kafelków, a każdy kafelek
+// dzielony jest najwyżej COARSE_LEVELS razy, co daje około samplesPerPixel
+// próbek na piksel urządzenia w najdrobniejszym podziale. Gładkie funkcje
+// kosztują ułamek budżetu, a mały podgląd dostaje proporcjonalnie mniej.
+//
+// Szerokość kafelka jest potęgą dwójki (poziom piramidy gridLevel) zależną
+// tylko od szerokości widoku: przy przesuwaniu węzły zostają w tych samych
+// miejscach osi x, a przy powiększaniu wracamy do poziomów już policzonych.
+// Kafelki poziomu próbkowane są w skali nominalnej tileScale, która różni
+// się od bieżącej najwyżej o czynnik sqrt(2) (oś y ma tę samą skalę co x,
+// bo CoordinateSystem zachowuje proporcje).
+void FunctionSampler::updateSampleBudget() {
+    const int COARSE_LEVELS = 4;
+    const int MIN_INTERVALS = 8;
+
+    float budget = max(pixelWidth * samplesPerPixel, (float)MIN_INTERVALS);
+    coarseIntervals = max((int)ceil(budget / (1 << COARSE_LEVELS)), MIN_INTERVALS);
+
+    pixelsPerUnitX = pixelWidth / (xMax - xMin);
+    pixelsPerUnitY = pixelHeight / (yMax - yMin);
+
+    double raw = (double)(xMax - xMin) / coarseIntervals;
+    if (!(raw > 0.0) || isinf(raw)) raw = 1.0;
+    gridLevel = (int)round(log2(raw));
+    gridStep = ldexp(1.0, gridLevel);
+    maxDepth = COARSE_LEVELS;
+    tileScale = (float)((1 << COARSE_LEVELS) / (samplesPerPixel * gridStep));
+
+    firstCell = (long long)floor(xMin / gridStep);
+    endCell = max((long long)ceil(xMax / gridStep), firstCell + 1);
+}
+
+// Węzły siatki od first do last włącznie
+void FunctionSampler::fillSampleGrid(long long first, long long last, vector<float>& xs) const {
+    size_t count = (size_t)(last - first + 1);
+
+    xs.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = (float)((first + (long long)i) * gridStep);
+    }
+}
+
+// Bufory jednego wątku dla refineRun i runTask
+struct FunctionSampler::RefineScratch {
+    vector<float> nodeX, nodeY, graphY;
+    vector<Point> levelPoints, nextPoints;
+    vector<unsigned char> levelSplit, nextSplit, levelNode, nextNode;
+    vector<float> midX, midY;
+};
+
+static bool isFinitePoint(const Point& p) {
+    return !isnan(p.y) && !isinf(p.y);
+}
+
+// Dzielimy dalej, gdy środek odchodzi od cięciwy o więcej niż tolerancja
+// w pikselach, albo gdy w przedziale jest granica dziedziny (część NAN).
+// Skala to nominalna skala poziomu piramidy (tileScale), a nie bieżąca,
+// żeby kafelki nie zależały od tego, przy jakim powiększeniu powstały.
+bool FunctionSampler::needsRefinement(const Point& a, const Point& m, const Point& b) const {
+    bool fa = isFinitePoint(a), fm = isFinitePoint(m), fb = isFinitePoint(b);
+    if (!fa && !fm && !fb) return false;
+    if (!fa || !fm || !fb) return true;
+    float chord = 0.5f * (a.y + b.y);
+    return fabs(m.y - chord) * tileScale > tolerancePixels;
+}
+
+// Odległość m od odcinka a-b w pikselach mniejsza niż ćwierć tolerancji
+bool FunctionSampler::isCollinear(const Point& a, const Point& m, const Point& b) const {
+    float dx = (b.x - a.x) * pixelsPerUnitX, dy = (b.y - a.y) * pixelsPerUnitY;
+    float mx = (m.x - a.x) * pixelsPerUnitX, my = (m.y - a.y) * pixelsPerUnitY;
+    float length = sqrt(dx * dx + dy * dy);
+    if (length <= 0.0f) return true;
+    return fabs(mx * dy - my * dx) / length < 0.25f * tolerancePixels;
+}
+
+// Próbkowanie adaptacyjne ciągu komórek siatki (węzły nodeX, wartości nodeY).
+// Poziom po poziomie dzieli na pół przedziały, które nie spełniają
+// needsRefinement; środki całego poziomu liczone są jednym evaluateBatch.
+// Przedział, który po maxDepth podziałach nadal odbiega od cięciwy, a środek nie
+// leży między końcami, traktujemy jako nieciągłość (np. asymptota tan)
+// i przerywamy tam linię; strome, ale monotoniczne fragmenty zostają ciągłe.
+// Wynik zostaje w scratch.levelPoints, levelNode oznacza węzły siatki.
+void FunctionSampler::refineRun(const MathExpressionParser& parser, span<const float> nodeX, span<const float> nodeY,
+                                RefineScratch& scratch, size_t& count) const {
+    vector<Point>& levelPoints = scratch.levelPoints;
+    vector<Point>& nextPoints = scratch.nextPoints;
+    vector<unsigned char>& levelSplit = scratch.levelSplit;
+    vector<unsigned char>& nextSplit = scratch.nextSplit;
+    vector<unsigned char>& levelNode = scratch.levelNode;
+    vector<unsigned char>& nextNode = scratch.nextNode;
+    vector<float>& midX = scratch.midX;
+    vector<float>& midY = scratch.midY;
+
+    levelPoints.clear();
+    for (size_t i = 0; i < nodeX.size(); i++) levelPoints.emplace_back(nodeX[i], nodeY[i]);
+    levelSplit.assign(levelPoints.size() - 1, 1);
+    levelNode.assign(levelPoints.size(), 1);
+
+    for (int depth = 0; depth <= maxDepth; depth++) {
+        midX.clear();
+        for (size_t i = 0; i < levelSplit.size(); i++) {
+            if (levelSplit[i]) midX.push_back(0.5f * (levelPoints[i].x + levelPoints[i + 1].x));
+        }
+        if (midX.empty()) break;
+        midY.resize(midX.size());
+        parser.evaluateBatch(midX, midY);
+        count += midX.size();
+
+        bool last = depth == maxDepth;
+        nextPoints.clear();
+        nextSplit.clear();
+        nextNode.clear();
+        size_t k = 0;
+        for (size_t i = 0; i < levelSplit.size(); i++) {
+            const Point& a = levelPoints[i];
+            const Point& b = levelPoints[i + 1];
+            nextPoints.push_back(a);
+            nextNode.push_back(levelNode[i]);
+            if (!levelSplit[i]) {
+                nextSplit.push_back(0);
+                continue;
+            }
+
+            Point m(midX[k], midY[k]);
+            k++;
+            bool refine = needsRefinement(a, m, b);
+            bool between = (m.y - a.y) * (b.y - m.y) >= 0.0f;
+            if (last && refine && !between && isFinitePoint(a) && isFinitePoint(m) && isFinitePoint(b)) {
+                // Środek poza przedziałem [a.y, b.y] na najmniejszej skali: skok,
+                // przerywamy linię w połówce o większej różnicy
+                bool leftJump = fabs(m.y - a.y) > fabs(b.y - m.y);
+                if (leftJump) nextPoints.emplace_back(NAN, NAN);
+                nextPoints.push_back(m);
+                if (!leftJump) nextPoints.emplace_back(NAN, NAN);
+                nextNode.insert(nextNode.end(), 2, 0);
+                continue;
+            }
+            nextPoints.push_back(m);
+            nextNode.push_back(0);
+            nextSplit.push_back(refine);
+            nextSplit.push_back(refine);
+        }
+        nextPoints.push_back(levelPoints.back());
+        nextNode.push_back(1);
+        swap(levelPoints, nextPoints);
+        swap(levelSplit, nextSplit);
+        swap(levelNode, nextNode);
+        if (last) break;
+    }
+}
+
+// Dzieli scratch.levelPoints na kafelki (od węzła do węzła włącznie)
+void FunctionSampler::splitTiles(const RefineScratch& scratch, vector<vector<Point>>& tiles) const {
+    const vector<Point>& levelPoints = scratch.levelPoints;
+    size_t count = 0;
+    for (size_t i = 1; i < levelPoints.size(); i++) {
+        if (scratch.levelNode[i]) count++;
+    }
+    tiles.resize(count);
+
+    size_t t = 0;
+    tiles[0].clear();
+    tiles[0].push_back(levelPoints[0]);
+    for (size_t i = 1; i < levelPoints.size(); i++) {
+        tiles[t].push_back(levelPoints[i]);
+        if (scratch.levelNode[i] && ++t < count) {
+            tiles[t].clear();
+            tiles[t].push_back(levelPoints[i]);
+        }
+    }
+}
+
+// Zadania dla ciągów brakujących kafelków widoku, po najwyżej CHUNK_TILES.
+// Znalezione kafelki stają się najświeższe i nie zostaną wyparte w tym
+// przebiegu; dla funkcji z grafu brakujące węzły trafiają do graphMissing.
+void FunctionSampler::addTasks(Entry& entry, bool graphNodes) {
+    entry.tiles.beginPass();
+    for (long long k = firstCell; k < endCell;) {
+        if (entry.tiles.find(gridLevel, k)) { k++; continue; }
+        long long first = k;
+        while (k < endCell && k - first < CHUNK_TILES && !entry.tiles.find(gridLevel, k)) {
+            if (graphNodes) graphMissing[k - firstCell] = 1;
+            k++;
+        }
+
+        if (taskCount == tasks.size()) tasks.emplace_back();
+        SampleTask& task = tasks[taskCount++];
+        task.entry = &entry;
+        task.first = first;
+        task.last = k;
+        task.evaluations = 0;
+    }
+}
+
+// Wartości wszystkich wyjść grafu w węzłach kawałka, przepisane do graphY
+// (wiersz na wyjście, kolumna na węzeł widoku). Węzeł wspólny z następnym
+// kawałkiem zapisuje tylko tamten.
+void FunctionSampler::evaluateGraphChunk(const GraphChunk& chunk) {
+    thread_local RefineScratch scratch;
+    fillSampleGrid(chunk.first, chunk.last, scratch.nodeX);
+    size_t count = scratch.nodeX.size();
+    scratch.graphY.resize(graph.outputCount() * count);
+    graph.evaluate(scratch.nodeX, scratch.graphY);
+
+    size_t offset = (size_t)(chunk.first - firstCell);
+    size_t written = chunk.sharedLast ? count - 1 : count;
+    for (size_t k = 0; k < graph.outputCount(); k++) {
+        auto row = scratch.graphY.begin() + k * count;
+        copy(row, row + written, graphY.begin() + k * viewNodes + offset);
+    }
+}
+
+void FunctionSampler::runTask(SampleTask& task) const {
+    thread_local RefineScratch scratch;
+    const Entry& entry = *task.entry;
+    const MathExpressionParser& parser = *entry.parser;
+
+    fillSampleGrid(task.first, task.last, scratch.nodeX);
+    size_t count = scratch.nodeX.size();
+    span<const float> nodeY;
+    if (entry.graphOutput >= 0) {
+        nodeY = span<const float>(graphY).subspan(entry.graphOutput * viewNodes + (size_t)(task.first - firstCell), count);
+    } else {
+        scratch.nodeY.resize(count);
+        parser.evaluateBatch(scratch.nodeX, scratch.nodeY);
+        task.evaluations += count;
+        nodeY = scratch.nodeY;
+    }
+
+    refineRun(parser, scratch.nodeX, nodeY, scratch, task.evaluations);
+    splitTiles(scratch, task.tiles);
+}
+
+// Punkt niezdefiniowany zamyka odcinek, punkty współliniowe są scalane
+void FunctionSampler::appendPoint(Polyline& out, const Point& p) const {
+    if (!isFinitePoint(p)) {
+        out.breakSegment();
+        return;
+    }
+    size_t n = out.size();
+    if (out.openLength() >= 2 && isCollinear(Point(out.x[n - 2], out.y[n - 2]), Point(out.x[n - 1], out.y[n - 1]), p)) {
+        out.replaceLast(p.x, p.y);
+    } else {
+        out.append(p.x, p.y);
+    }
+}
+
+// Wersja do rysowania: przycięta do widoku z marginesem (bez odległych
+// punktów stromych funkcji i asymptot), a gdy zostaje więcej niż 4 punkty
+// na kolumnę pikseli, także po redukcji M4. Kolumny mają szerokość piksela
+// i pokrywają cały zakres przycięcia [clipXMin, clipXMax], a nie tylko widok,
+// więc przy marginesie jednej szerokości widoku z każdej strony wynik ma
+// najwyżej 4 * 3 * pixelWidth punktów plus 4 na przerwę. Bez obu kroków
+// to kopia krzywej.
+// Wynik trafia do FunctionData::rendered i jest rysowany bez zmian w każdej
+// klatce aż do następnego próbkowania, czyli zmiany zakresu, rozmiaru
+// albo wyrażenia.
+void FunctionSampler::prepareRenderCurve(const Polyline& curve, Polyline& out) const {
+    thread_local Polyline scratch;
+    const Polyline* source = &curve;
+    if (clipPolyline(curve, clipXMin, clipXMax, clipYMin, clipYMax, out)) source = &out;
+    double margin = ((double)clipXMax - clipXMin) / ((double)xMax - xMin);
+    if (!(margin >= 1.0 && margin <= 16.0)) margin = 1.0;
+    int columns = (int)ceil(pixelWidth * margin);
+    if (source->size() > 4 * (size_t)columns) {
+        decimatePixelColumns(*source, clipXMin, clipXMax, columns, scratch);
+        swap(out, scratch);
+    } else if (source == &curve) {
+        out = curve;
+    }
+}
+
+// Kafelki sąsiadują węzłami, więc pierwszy punkt każdego kolejnego kafelka
+// jest pomijany.
+void FunctionSampler::assemblePoints(Entry& entry, Polyline& out) {
+    out.clear();
+    for (long long k = firstCell; k < endCell; k++) {
+        const SampleTile* tile = entry.tiles.find(gridLevel, k);
+        if (!tile) continue;
+        size_t start = (k == firstCell) ? 0 : 1;
+        for (size_t i = start; i < tile->points.size(); i++) appendPoint(out, tile->points[i]);
+    }
+}
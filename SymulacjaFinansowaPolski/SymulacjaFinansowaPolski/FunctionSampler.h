@@ -0,0 +1,123 @@
+#ifndef FUNCTIONSAMPLER_H
+#define FUNCTIONSAMPLER_H
+
+#include <vector>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include "Point.h"
+#include "Polyline.h"
+#include "SampleTileCache.h"
+#include "ExpressionGraph.h"
+#include "MathExpressionParser.h"
+
+// Jedno zlecenie próbkowania: widok, parametry i funkcje plotera w chwili zlecenia
+struct SamplingJob {
+    unsigned version;
+    float xMin, xMax;
+    int pixelWidth, pixelHeight;    // bufor ramki w pikselach urządzenia
+    float yMin, yMax;
+    float clipXMin, clipXMax, clipYMin, clipYMax;  // widok z marginesem, do rysowania
+    float samplesPerPixel;
+    float tolerancePixels;
+    size_t tileCacheCapacity;
+    std::vector<unsigned> ids;      // funkcje do próbkowania (FunctionData::id)
+    std::vector<std::shared_ptr<const MathExpressionParser>> parsers;
+    std::vector<unsigned> liveIds;  // wszystkie funkcje plotera; kafelki pozostałych są usuwane
+
+    SamplingJob();
+};
+
+struct SamplingResult {
+    unsigned version;
+    std::vector<unsigned> ids;                  // kopia ids zlecenia
+    std::vector<Polyline> curves;               // w kolejności ids
+    std::vector<Polyline> rendered;             // przycięte i zredukowane do rysowania
+    size_t evaluations;
+
+    SamplingResult();
+};
+
+// Próbkowanie adaptacyjne funkcji na piramidzie kafelków. Trzyma między
+// zleceniami kafelki każdej funkcji i wspólny ExpressionGraph. Brakujące
+// kafelki liczone są w kawałkach po CHUNK_TILES na wątkach TaskScheduler,
+// a wynik nie zależy od liczby wątków. Sam obiekt nie jest bezpieczny
+// wątkowo: w programie run() woła tylko wątek próbkujący plotera.
+class FunctionSampler {
+private:
+    struct Entry {
+        std::shared_ptr<const MathExpressionParser> parser;
+        SampleTileCache tiles;
+        int graphOutput = -1;   // wyjście w graph, -1 gdy liczona osobno
+    };
+
+    std::unordered_map<unsigned, Entry> entries;
+    std::vector<Entry*> active;                         // wpisy funkcji bieżącego zlecenia
+    ExpressionGraph graph;
+    // Z czego zbudowano graph: (id funkcji, parser) w kolejności wyjść
+    std::vector<std::pair<unsigned, const MathExpressionParser*>> graphParsers;
+    std::vector<float> graphY;      // węzły widoku dla wyjść grafu: graphY[k * viewNodes + i]
+
+    float xMin, xMax;
+    int pixelWidth, pixelHeight;
+    float yMin, yMax;
+    float clipXMin, clipXMax, clipYMin, clipYMax;
+    float samplesPerPixel;          // docelowa gęstość próbek w najdrobniejszym podziale
+    float tolerancePixels;          // dopuszczalne odejście środka od cięciwy
+    int coarseIntervals;            // docelowa liczba kafelków w widoku
+    int gridLevel;                  // poziom piramidy: kafelki szerokości 2^gridLevel
+    double gridStep;                // 2^gridLevel
+    long long firstCell, endCell;   // widoczne kafelki [firstCell, endCell)
+    int maxDepth;                   // ile razy najwyżej dzielimy kafelek na pół
+    float tileScale;                // nominalne piksele na jednostkę dla gridLevel
+    float pixelsPerUnitX, pixelsPerUnitY;
+    size_t evaluations;
+    static const long long CHUNK_TILES = 16;    // najwięcej kafelków w jednym zadaniu
+
+    // Ciąg brakujących kafelków [first, last) jednej funkcji; liczony
+    // równolegle, wynik (tiles) trafia do pamięci funkcji po kolei
+    struct SampleTask {
+        Entry* entry;
+        long long first, last;
+        size_t evaluations;
+        std::vector<std::vector<Point>> tiles;
+    };
+    struct GraphChunk {
+        long long first, last;
+        bool sharedLast;        // węzeł last zapisuje następny kawałek
+    };
+    struct RefineScratch;
+
+    // Bufory używane ponownie między zleceniami
+    std::vector<SampleTask> tasks;
+    size_t taskCount;
+    std::vector<GraphChunk> graphChunks;
+    std::vector<unsigned char> adaptive, graphMissing;
+    size_t viewNodes;
+
+    void prepare(const SamplingJob& job);
+    void rebuildGraph(const std::vector<unsigned>& ids);
+    void updateSampleBudget();
+    bool sampleSpecial(const MathExpressionParser& parser, Polyline& out);
+    void fillSampleGrid(long long first, long long last, std::vector<float>& xs) const;
+    bool needsRefinement(const Point& a, const Point& m, const Point& b) const;
+    bool isCollinear(const Point& a, const Point& m, const Point& b) const;
+    void refineRun(const MathExpressionParser& parser, std::span<const float> nodeX, std::span<const float> nodeY,
+                   RefineScratch& scratch, size_t& count) const;
+    void splitTiles(const RefineScratch& scratch, std::vector<std::vector<Point>>& tiles) const;
+    void addTasks(Entry& entry, bool graphNodes);
+    void evaluateGraphChunk(const GraphChunk& chunk);
+    void runTask(SampleTask& task) const;
+    void appendPoint(Polyline& out, const Point& p) const;
+    void assemblePoints(Entry& entry, Polyline& out);
+    void prepareRenderCurve(const Polyline& curve, Polyline& out) const;
+
+public:
+    FunctionSampler();
+
+    void run(const SamplingJob& job, SamplingResult& result);
+    void clear();
+};
+
+#endif // FUNCTIONSAMPLER_H
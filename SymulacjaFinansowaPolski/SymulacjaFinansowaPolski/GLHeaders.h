@@ -0,0 +1,14 @@
+#ifndef GLHEADERS_H
+#define GLHEADERS_H
+
+// OpenGL w programie przychodzi z GLFW. Eksporter bez okna na Linuksie
+// (HEADLESS_EXPORT, kontekst z EGL) bierze GL/gl.h wprost i nie potrzebuje
+// GLFW; GLFWwindow jest wtedy tylko zapowiedzią typu.
+#ifdef HEADLESS_EXPORT
+#include <GL/gl.h>
+typedef struct GLFWwindow GLFWwindow;
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+#endif
@@ -1,9 +1,14 @@
 #include "MathExpressionParser.h"
+#include "ExpressionOptimizer.h"
 #include <cmath>
 #include <algorithm>
 #include <cctype>
-#include <stdexcept>
-#include <sstream>
+#include <cstring>
+#include <charconv>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -13,14 +18,14 @@
 #endif
 
 using namespace std;
-MathExpressionParser::MathExpressionParser() : type(UNKNOWN), verticalLineX(0.0f), horizontalLineY(0.0f),
+MathExpressionParser::MathExpressionParser() : type(UNKNOWN), tokenPos(0), verticalLineX(0.0f), horizontalLineY(0.0f),
                                              circleCenterX(0.0f), circleCenterY(0.0f), circleRadius(1.0f),
-                                             isCircle(false), errorMessage("") {}
+                                             isCircle(false) {}
 
 string MathExpressionParser::removeWhitespace(const string& str) {
     string result;
     remove_copy_if(str.begin(), str.end(), back_inserter(result),
-                   [](char c) { return isspace(c); });
+                   [](unsigned char c) { return isspace(c); });
     return result;
 }
 
@@ -38,11 +43,82 @@ bool MathExpressionParser::contains(const string& str, const string& substr) {
 void MathExpressionParser::replaceAll(string& str, const string& from, const string& to) {
     size_t start_pos = 0;
     while((start_pos = str.find(from, start_pos)) != string::npos) {
-        str.replace(start_pos, from.length(), to);
+        replaceRange(str, start_pos, from.length(), to);
         start_pos += to.length();
     }
 }
 
+// Zamiana fragmentu wyrażenia razem z mapą pozycji: nowe znaki wskazują po
+// kolei na znaki zastąpione (nadmiarowe na ostatni z nich), wstawione bez
+// zastępowania - na znak, przed którym stoją
+void MathExpressionParser::replaceRange(string& str, size_t position, size_t length, const string& to) {
+    vector<size_t> mapped(to.length());
+    for (size_t k = 0; k < to.length(); k++) {
+        mapped[k] = sourceIndex[position + (length > 0 ? min(k, length - 1) : 0)];
+    }
+    str.replace(position, length, to);
+    sourceIndex.erase(sourceIndex.begin() + position, sourceIndex.begin() + position + length);
+    sourceIndex.insert(sourceIndex.begin() + position, mapped.begin(), mapped.end());
+}
+
+// Liczba w zapisie stałoprzecinkowym (jak from_chars z chars_format::fixed).
+// libc++ z Xcode 16 nie ma from_chars dla float/double, a __cpp_lib_to_chars
+// definiuje dopiero przy pełnej obsłudze; wtedy zapis wycinamy sami i zamieniamy
+// strtof/strtod na ograniczonej kopii. Program nie zmienia locale, więc
+// kropka dziesiętna jest taka jak w "C".
+template <typename T>
+static from_chars_result parseFixed(const char* first, const char* last, T& value) {
+#if defined(__cpp_lib_to_chars)
+    return from_chars(first, last, value, chars_format::fixed);
+#else
+    const char* p = first;
+    if (p != last && *p == '-') p++;
+    size_t digits = 0;
+    while (p != last && isdigit(static_cast<unsigned char>(*p))) { p++; digits++; }
+    if (p != last && *p == '.') {
+        p++;
+        while (p != last && isdigit(static_cast<unsigned char>(*p))) { p++; digits++; }
+    }
+    if (digits == 0) return { first, errc::invalid_argument };
+
+    string copy(first, p);
+    errno = 0;
+    T parsed;
+    if constexpr (is_same_v<T, float>) parsed = strtof(copy.c_str(), nullptr);
+    else parsed = strtod(copy.c_str(), nullptr);
+    if (errno == ERANGE || fabs(parsed) > numeric_limits<T>::max()) return { p, errc::result_out_of_range };
+    value = parsed;
+    return { p, errc() };
+#endif
+}
+
+// Cała liczba z opcjonalnym znakiem, niezależnie od locale i bez wyjątków.
+// W odróżnieniu od stof nie akceptuje śmieci za liczbą ("2+3" to nie 2).
+bool MathExpressionParser::parseNumber(string_view text, float& value) {
+    if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+    if (text.empty()) return false;
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = parseFixed(text.data(), end, value);
+    return ec == errc() && ptr == end;
+}
+
+// Zapamiętuje tylko kod i fragment wyrażenia; tekst składa getErrorMessage().
+// Pozycje po normalizacji są przeliczane na tekst wpisany przez użytkownika,
+// więc fragment obejmuje też spacje wewnątrz niego.
+void MathExpressionParser::setError(ParseErrorCode code, size_t position, size_t length) {
+    error.code = code;
+    error.position = position;
+    error.length = length;
+    if (position == ParseError::NO_POSITION || sourceIndex.empty()) return;
+
+    size_t last = sourceIndex.size() - 1;
+    error.position = sourceIndex[min(position, last)];
+    if (length > 0) {
+        size_t end = sourceIndex[min(position + length - 1, last)] + 1;
+        error.length = max(end, error.position + 1) - error.position;
+    }
+}
+
 // Walidacja i Normalizacja
 
 bool MathExpressionParser::isValidCharacter(char c) {
@@ -54,20 +130,26 @@ void MathExpressionParser::normalizeExpression(string& expr) {
     
     //Obsługa wartości bezwzględnej
     string result = "";
+    vector<size_t> resultIndex;
         bool opening = true;
         for (size_t i = 0; i < expr.length(); ++i) {
             if (expr[i] == '|') {
                 if (opening) result += "abs(";
                 else result += ")";
+                resultIndex.resize(result.length(), sourceIndex[i]);
                 opening = !opening;
             } else {
                 result += expr[i];
+                resultIndex.push_back(sourceIndex[i]);
             }
         }
         if (!opening) {
             result += ")";
+            resultIndex.push_back(sourceIndex.back());
         }
+        resultIndex.push_back(sourceIndex.back());
         expr = result;
+        sourceIndex = std::move(resultIndex);
     
     //Wykrywanie okręgu
     if ((contains(expr, "(x") && contains(expr, ")^2") &&
@@ -80,9 +162,9 @@ void MathExpressionParser::normalizeExpression(string& expr) {
 
     //Normalizacja y= / f(x)=
     if (expr.find("f(x)=") == 0) {
-        expr = "y=" + expr.substr(5);
+        replaceRange(expr, 0, 5, "y=");
     } else if (expr.find("f(x)") == 0 && expr.length() > 4) {
-        expr = "y=" + expr.substr(4);
+        replaceRange(expr, 0, 4, "y=");
     }
 
     //Linie poziome y = stała
@@ -92,13 +174,11 @@ void MathExpressionParser::normalizeExpression(string& expr) {
             !contains(afterEqual, "sin") && !contains(afterEqual, "cos") &&
             !contains(afterEqual, "tan") && !contains(afterEqual, "cot") &&
             !contains(afterEqual, "log") && !contains(afterEqual, "ln") &&
-            !contains(afterEqual, "abs") && !contains(afterEqual, "exp")) {
-            try {
-                horizontalLineY = stof(afterEqual);
-                type = HORIZONTAL_LINE;
-                expr = "horizontal";
-                return;
-            } catch (...) {}
+            !contains(afterEqual, "abs") && !contains(afterEqual, "exp") &&
+            parseNumber(afterEqual, horizontalLineY)) {
+            type = HORIZONTAL_LINE;
+            replaceRange(expr, 0, expr.length(), "horizontal");
+            return;
         }
     }
 
@@ -108,13 +188,11 @@ void MathExpressionParser::normalizeExpression(string& expr) {
         if (eqPos != string::npos) {
             string afterEqual = expr.substr(eqPos + 1);
             if (!contains(afterEqual, "x") && !contains(afterEqual, "y") &&
-                !contains(afterEqual, "sin") && !contains(afterEqual, "cos")) {
-                try {
-                    verticalLineX = stof(afterEqual);
-                    type = VERTICAL_LINE;
-                    expr = "vertical";
-                    return;
-                } catch (...) {}
+                !contains(afterEqual, "sin") && !contains(afterEqual, "cos") &&
+                parseNumber(afterEqual, verticalLineX)) {
+                type = VERTICAL_LINE;
+                replaceRange(expr, 0, expr.length(), "vertical");
+                return;
             }
         }
     }
@@ -125,7 +203,7 @@ void MathExpressionParser::normalizeExpression(string& expr) {
 
     // 7. Usunięcie "y=" (dla normalnej funkcji)
     if (expr.find("y=") == 0 && type != VERTICAL_LINE && type != HORIZONTAL_LINE) {
-        expr = expr.substr(2);
+        replaceRange(expr, 0, 2, "");
     }
 }
 
@@ -136,354 +214,362 @@ void MathExpressionParser::parseCircleEquation(const string& expr) {
     circleCenterY = 0.0f;
     circleRadius = 0.0f;
 
-    try {
-        size_t eqPos = expr.find('=');
-        if (eqPos == string::npos) return;
-
-        string rightSide = expr.substr(eqPos + 1);
-        float radiusSquared = stof(rightSide);
-        if (radiusSquared >= 0) {
-            circleRadius = sqrt(radiusSquared);
-        } else {
-            errorMessage = "Blad: Ujemny promien ($R^2 < 0$) dla rownania okregu.";
-            isCircle = false;
-            type = UNKNOWN;
-            return;
-        }
+    size_t eqPos = expr.find('=');
+    if (eqPos == string::npos) return;
 
-        string leftSide = expr.substr(0, eqPos);
-
-        size_t xStart = leftSide.find("(x");
-        if (xStart != string::npos) {
-            size_t xEnd = leftSide.find(")^2", xStart);
-            if (xEnd != string::npos) {
-                string xExpr = leftSide.substr(xStart + 1, xEnd - xStart - 1);
-                if (xExpr.length() > 1) {
-                    char op = xExpr[1];
-                    float value = stof(xExpr.substr(2));
-                    circleCenterX = (op == '-') ? value : -value;
-                }
-            }
-        } else if (contains(leftSide, "x^2")) {
-            circleCenterX = 0.0f;
-        }
-
-        size_t yStart = leftSide.find("(y");
-        if (yStart != string::npos) {
-            size_t yEnd = leftSide.find(")^2", yStart);
-            if (yEnd != string::npos) {
-                string yExpr = leftSide.substr(yStart + 1, yEnd - yStart - 1);
-                if (yExpr.length() > 1) {
-                    char op = yExpr[1];
-                    float value = stof(yExpr.substr(2));
-                    circleCenterY = (op == '-') ? value : -value;
-                }
-            }
-        } else if (contains(leftSide, "y^2")) {
-            circleCenterY = 0.0f;
-        }
-
-    } catch (...) {
-        errorMessage = "Blad parsowania rownania okregu.";
+    string_view rightSide = string_view(expr).substr(eqPos + 1);
+    float radiusSquared = 0.0f;
+    if (!parseNumber(rightSide, radiusSquared)) {
+        setError(PARSE_CIRCLE_SYNTAX, eqPos + 1, rightSide.length());
         isCircle = false;
         type = UNKNOWN;
+        return;
     }
-}
-
-void MathExpressionParser::parsePolynomial(const string& expr) {
-    polynomialTerms.clear();
-    string cleanExpr = expr;
-
-    if (cleanExpr[0] == '-') {
-        cleanExpr = "0" + cleanExpr;
+    if (radiusSquared >= 0) {
+        circleRadius = sqrt(radiusSquared);
+    } else {
+        setError(PARSE_NEGATIVE_RADIUS, eqPos + 1, rightSide.length());
+        isCircle = false;
+        type = UNKNOWN;
+        return;
     }
-    
-    replaceAll(cleanExpr, "+-", "-");
-    replaceAll(cleanExpr, "-+", "-");
 
-    vector<string> terms;
-    string currentTerm;
-    int parenCount = 0;
+    string_view leftSide = string_view(expr).substr(0, eqPos);
+
+    // Środek z postaci (x-a)^2 / (x+a)^2, analogicznie dla y
+    auto parseCenter = [&](const char* open, float& center) {
+        size_t start = leftSide.find(open);
+        if (start == string_view::npos) return true;
+        size_t end = leftSide.find(")^2", start);
+        if (end == string_view::npos) return true;
+        string_view inner = leftSide.substr(start + 1, end - start - 1);
+        if (inner.length() <= 1) return true;
+        char op = inner[1];
+        float value = 0.0f;
+        if ((op != '-' && op != '+') || !parseNumber(inner.substr(2), value)) return false;
+        center = (op == '-') ? value : -value;
+        return true;
+    };
+
+    if (!parseCenter("(x", circleCenterX) || !parseCenter("(y", circleCenterY)) {
+        setError(PARSE_CIRCLE_SYNTAX);
+        isCircle = false;
+        type = UNKNOWN;
+    }
+}
 
-    for (size_t i = 0; i < cleanExpr.length(); i++) {
-        char c = cleanExpr[i];
-        if (c == '(') parenCount++;
-        else if (c == ')') parenCount--;
+// Czy wielomian ma najwyżej jeden niezerowy wyraz (stała albo a*x^k)
+static bool isMonomial(const vector<double>& coefficients) {
+    return count_if(coefficients.begin(), coefficients.end(), [](double c) { return c != 0.0; }) <= 1;
+}
 
-        if (parenCount == 0 && (c == '+' || c == '-') && i > 0 && cleanExpr[i-1] != '^' && cleanExpr[i-1] != 'e') {
-            if (!currentTerm.empty()) {
-                terms.push_back(currentTerm);
+// Współczynniki wielomianu (indeks = wykładnik) wprost z drzewa wyrażenia.
+// Zwraca false, jeśli wyrażenie nie jest wielomianem: zawiera funkcje, dzieli
+// przez x, ma wykładnik niecałkowity albo stopień powyżej MAX_POLYNOMIAL_DEGREE.
+// Dzielenie przez stałą bliską zeru też odpada, bo interpreter daje wtedy NAN.
+//
+// Wyrażenie musi już być sumą jednomianów: mnożyć wolno tylko przez jednomian,
+// a potęgować tylko jednomian. Rozwinięcie np. (x-100)^4 daje współczynniki
+// rzędu 1e8, które przy x bliskim 100 znoszą się w float do zupełnie złego
+// wyniku; takie wyrażenia liczy interpreter w postaci wpisanej przez użytkownika.
+bool MathExpressionParser::parsePolynomial(const ExpressionNode& node, vector<double>& coefficients) {
+    vector<double> left, right;
+
+    switch (node.kind) {
+        case NODE_CONSTANT:
+            coefficients.assign(1, node.value);
+            return true;
+        case NODE_VARIABLE:
+            coefficients = { 0.0, 1.0 };
+            return true;
+        case NODE_NEG:
+            if (!parsePolynomial(*node.left, coefficients)) return false;
+            for (double& c : coefficients) c = -c;
+            return true;
+        case NODE_ADD:
+        case NODE_SUB: {
+            if (!parsePolynomial(*node.left, left) || !parsePolynomial(*node.right, right)) return false;
+            double sign = (node.kind == NODE_ADD) ? 1.0 : -1.0;
+            if (right.size() > left.size()) left.resize(right.size(), 0.0);
+            for (size_t k = 0; k < right.size(); k++) left[k] += sign * right[k];
+            break;
+        }
+        case NODE_MUL: {
+            if (!parsePolynomial(*node.left, left) || !parsePolynomial(*node.right, right)) return false;
+            if (!isMonomial(left) && !isMonomial(right)) return false;
+            if (left.size() + right.size() - 2 > MAX_POLYNOMIAL_DEGREE) return false;
+            vector<double> product(left.size() + right.size() - 1, 0.0);
+            for (size_t i = 0; i < left.size(); i++)
+                for (size_t j = 0; j < right.size(); j++) product[i + j] += left[i] * right[j];
+            left = std::move(product);
+            break;
+        }
+        case NODE_DIV: {
+            if (!parsePolynomial(*node.left, left) || !parsePolynomial(*node.right, right)) return false;
+            if (right.size() != 1 || fabs(right[0]) < 0.000001) return false;
+            for (double& c : left) c /= right[0];
+            break;
+        }
+        case NODE_POW: {
+            if (!parsePolynomial(*node.left, left) || !parsePolynomial(*node.right, right)) return false;
+            if (right.size() != 1) return false;
+            double exponent = right[0];
+            if (left.size() == 1) {
+                if (left[0] < 0 && fabs(exponent - round(exponent)) > 0.0001) return false;
+                left[0] = pow(left[0], exponent);
+                break;
             }
-            currentTerm = c;
-        } else {
-            currentTerm += c;
+            if (!isMonomial(left) || exponent != round(exponent) || exponent < 0 ||
+                exponent * (left.size() - 1) > MAX_POLYNOMIAL_DEGREE) return false;
+            vector<double> power(1, 1.0);
+            for (int n = 0; n < static_cast<int>(exponent); n++) {
+                vector<double> next(power.size() + left.size() - 1, 0.0);
+                for (size_t i = 0; i < power.size(); i++)
+                    for (size_t j = 0; j < left.size(); j++) next[i + j] += power[i] * left[j];
+                power = std::move(next);
+            }
+            left = std::move(power);
+            break;
         }
+        default:
+            return false;
     }
-    if (!currentTerm.empty()) {
-        terms.push_back(currentTerm);
-    }
-
-    for (string& term : terms) {
-        if (term[0] == '+') term = term.substr(1);
 
-        if (contains(term, "x")) {
-            size_t xPos = term.find('x');
-            float coefficient = 1.0f;
-            float exponent = 1.0f;
+    for (double c : left) {
+        if (!isfinite(c)) return false;
+    }
+    while (left.size() > 1 && left.back() == 0.0) left.pop_back();
+    coefficients = std::move(left);
+    return true;
+}
 
-            string coeffStr = term.substr(0, xPos);
-            if (coeffStr.empty() || coeffStr == "+") {
-                coefficient = 1.0f;
-            } else if (coeffStr == "-") {
-                coefficient = -1.0f;
-            } else {
-                try {
-                    coefficient = stof(coeffStr);
-                } catch (...) {
-                    coefficient = 1.0f;
-                }
+// Tokenizacja i budowa drzewa wyrazenia
+
+// Jedno przejście po string_view; liczby czyta parseFixed (from_chars, gdy
+// jest dostępne, bez kopiowania podciągów). Błąd zwracany jest przez wartość, a kod i pozycja trafiają do error.
+bool MathExpressionParser::tokenize(string_view expr) {
+    static const struct { string_view name; TokenType type; NodeKind function; double value; } symbols[] = {
+        { "sin", TOKEN_FUNCTION, NODE_SIN, 0.0 },
+        { "cos", TOKEN_FUNCTION, NODE_COS, 0.0 },
+        { "tan", TOKEN_FUNCTION, NODE_TAN, 0.0 },
+        { "exp", TOKEN_FUNCTION, NODE_EXP, 0.0 },
+        { "abs", TOKEN_FUNCTION, NODE_ABS, 0.0 },
+        { "log", TOKEN_FUNCTION, NODE_LOG, 0.0 },
+        { "ln", TOKEN_FUNCTION, NODE_LN, 0.0 },
+        { "pi", TOKEN_NUMBER, NODE_CONSTANT, M_PI },
+        { "x", TOKEN_VARIABLE, NODE_VARIABLE, 0.0 },
+        { "e", TOKEN_NUMBER, NODE_CONSTANT, M_E }
+    };
+
+    tokens.clear();
+    size_t i = 0;
+    while (i < expr.length()) {
+        char c = expr[i];
+        Token token = { TOKEN_END, 0.0, NODE_CONSTANT, c, i };
+
+        if (isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* end = expr.data() + expr.length();
+            auto [ptr, ec] = parseFixed(expr.data() + i, end, token.value);
+            size_t next = ptr - expr.data();
+            if (ec != errc() || (next < expr.length() && (expr[next] == '.' || isdigit(static_cast<unsigned char>(expr[next]))))) {
+                size_t stop = i;
+                while (stop < expr.length() && (isdigit(static_cast<unsigned char>(expr[stop])) || expr[stop] == '.')) stop++;
+                setError(PARSE_INVALID_NUMBER, i, stop - i);
+                return false;
             }
+            token.type = TOKEN_NUMBER;
+            tokens.push_back(token);
+            i = next;
+            continue;
+        }
 
-            if (xPos + 1 < term.length() && term[xPos + 1] == '^') {
-                size_t expStart = xPos + 2;
-                string expStr = term.substr(expStart);
-                try {
-                    exponent = stof(expStr);
-                } catch (...) {
-                    exponent = 1.0f;
+        if (isalpha(static_cast<unsigned char>(c))) {
+            bool matched = false;
+            for (const auto& symbol : symbols) {
+                if (expr.substr(i).starts_with(symbol.name)) {
+                    token.type = symbol.type;
+                    token.function = symbol.function;
+                    token.value = symbol.value;
+                    tokens.push_back(token);
+                    i += symbol.name.length();
+                    matched = true;
+                    break;
                 }
             }
+            if (!matched) {
+                size_t stop = i;
+                while (stop < expr.length() && isalpha(static_cast<unsigned char>(expr[stop]))) stop++;
+                setError(PARSE_UNKNOWN_SYMBOL, i, stop - i);
+                return false;
+            }
+            continue;
+        }
 
-            polynomialTerms.emplace_back(coefficient, exponent);
-        } else {
-            try {
-                float constant = stof(term);
-                polynomialTerms.emplace_back(constant, 0.0f);
-            } catch (...) {}
+        if (c == '+' || c == '-' || c == '*' || c == '/' || c == '^') token.type = TOKEN_OPERATOR;
+        else if (c == '(') token.type = TOKEN_LPAREN;
+        else if (c == ')') token.type = TOKEN_RPAREN;
+        else {
+            setError(PARSE_UNKNOWN_SYMBOL, i, 1);
+            return false;
         }
+        tokens.push_back(token);
+        i++;
     }
-    type = POLYNOMIAL;
+
+    tokens.push_back({ TOKEN_END, 0.0, NODE_CONSTANT, '\0', expr.length() });
+    return true;
 }
 
-float MathExpressionParser::parseExpression(float x, const string& expr) {
-    if (expr.empty()) return 0.0f;
-    if (!errorMessage.empty()) return NAN;
+const MathExpressionParser::Token& MathExpressionParser::peek() const {
+    return tokens[tokenPos];
+}
 
-    string trimmed = expr;
+bool MathExpressionParser::startsOperand(const Token& token) const {
+    return token.type == TOKEN_NUMBER || token.type == TOKEN_VARIABLE ||
+           token.type == TOKEN_FUNCTION || token.type == TOKEN_LPAREN;
+}
 
-    if (trimmed[0] == '-') {
-        trimmed = "0" + trimmed;
+// Gramatyka (od najnizszego priorytetu):
+//   suma     := iloczyn (('+' | '-') iloczyn)*
+//   iloczyn  := implikowane (('*' | '/') implikowane)*
+//   implikowane := unarne potega*          np. 2x, 3sin(x), (x+1)(x-1)
+//   unarne   := ('-' | '+') unarne | potega
+//   potega   := element ('^' unarne)?      prawostronnie laczne, e^ -> exp
+//   element  := liczba | x | e | pi | funkcja '(' suma ')' | '(' suma ')'
+// Mnozenie implikowane wiaze mocniej niz '*' i '/', tak jak dotychczas: 1/2x = 1/(2x).
+
+unique_ptr<ExpressionNode> MathExpressionParser::parseSum() {
+    unique_ptr<ExpressionNode> node = parseProduct();
+    while (node && peek().type == TOKEN_OPERATOR && (peek().op == '+' || peek().op == '-')) {
+        NodeKind kind = (peek().op == '+') ? NODE_ADD : NODE_SUB;
+        tokenPos++;
+        unique_ptr<ExpressionNode> right = parseProduct();
+        if (!right) return nullptr;
+        node = make_unique<ExpressionNode>(kind, std::move(node), std::move(right));
     }
-    while (trimmed.length() > 2 && trimmed.front() == '(' && trimmed.back() == ')') {
-        size_t match = findMatchingParen(trimmed, 0);
-        if (match == trimmed.length() - 1) {
-            trimmed = trimmed.substr(1, trimmed.length() - 2);
-        } else {
-            break;
-        }
+    return node;
+}
+
+unique_ptr<ExpressionNode> MathExpressionParser::parseProduct() {
+    unique_ptr<ExpressionNode> node = parseImplicitProduct();
+    while (node && peek().type == TOKEN_OPERATOR && (peek().op == '*' || peek().op == '/')) {
+        NodeKind kind = (peek().op == '*') ? NODE_MUL : NODE_DIV;
+        tokenPos++;
+        unique_ptr<ExpressionNode> right = parseImplicitProduct();
+        if (!right) return nullptr;
+        node = make_unique<ExpressionNode>(kind, std::move(node), std::move(right));
     }
-    
-    //Dodawanie/Odejmowanie
-    int parenCount = 0;
-    size_t opPos = string::npos;
-    char op = '+';
-
-    for (size_t i = trimmed.length() - 1; i > 0; i--) {
-        char c = trimmed[i];
-        if (c == ')') parenCount++;
-        else if (c == '(') parenCount--;
-        else if (parenCount == 0 && (c == '+' || c == '-')) {
-            char prev = trimmed[i-1];
-            if (prev != 'e' && prev != 'E' && prev != '*' && prev != '/' && prev != '^' && prev != '(') {
-                opPos = i;
-                op = c;
-                break;
-            }
-        }
+    return node;
+}
+
+unique_ptr<ExpressionNode> MathExpressionParser::parseImplicitProduct() {
+    unique_ptr<ExpressionNode> node = parseUnary();
+    while (node && startsOperand(peek())) {
+        unique_ptr<ExpressionNode> right = parsePower();
+        if (!right) return nullptr;
+        node = make_unique<ExpressionNode>(NODE_MUL, std::move(node), std::move(right));
     }
+    return node;
+}
 
-    if (opPos != string::npos) {
-        string left = trimmed.substr(0, opPos);
-        string right = trimmed.substr(opPos + 1);
-        float leftVal = parseExpression(x, left);
-        float rightVal = parseExpression(x, right);
-        if (!errorMessage.empty() || isnan(leftVal) || isnan(rightVal)) return NAN;
-        return (op == '+') ? leftVal + rightVal : leftVal - rightVal;
+unique_ptr<ExpressionNode> MathExpressionParser::parseUnary() {
+    if (peek().type == TOKEN_OPERATOR && (peek().op == '-' || peek().op == '+')) {
+        bool negate = peek().op == '-';
+        tokenPos++;
+        unique_ptr<ExpressionNode> operand = parseUnary();
+        if (!operand || !negate) return operand;
+        return make_unique<ExpressionNode>(NODE_NEG, std::move(operand));
     }
+    return parsePower();
+}
 
-    //Mnożenie/Dzielenie
-    parenCount = 0;
-    opPos = string::npos;
-    char mulDivOp = ' ';
+unique_ptr<ExpressionNode> MathExpressionParser::parsePower() {
+    unique_ptr<ExpressionNode> base = parsePrimary();
+    if (!base || peek().type != TOKEN_OPERATOR || peek().op != '^') return base;
+    tokenPos++;
 
-    for (size_t i = trimmed.length() - 1; i > 0; i--) {
-        char c = trimmed[i];
-        if (c == ')') parenCount++;
-        else if (c == '(') parenCount--;
-        else if (parenCount == 0 && (c == '*' || c == '/')) {
-            opPos = i;
-            mulDivOp = c;
-            break;
-        }
+    unique_ptr<ExpressionNode> exponent = parseUnary();
+    if (!exponent) return nullptr;
+    if (base->kind == NODE_CONSTANT && base->value == M_E) {
+        return make_unique<ExpressionNode>(NODE_EXP, std::move(exponent));
     }
+    return make_unique<ExpressionNode>(NODE_POW, std::move(base), std::move(exponent));
+}
 
-    if (opPos != string::npos) {
-        string left = trimmed.substr(0, opPos);
-        string right = trimmed.substr(opPos + 1);
-        float leftVal = parseExpression(x, left);
-        float rightVal = parseExpression(x, right);
-        
-        if (!errorMessage.empty() || isnan(leftVal) || isnan(rightVal)) return NAN;
-
-        if (mulDivOp == '/') {
-                float leftVal = parseExpression(x, left);
-                float rightVal = parseExpression(x, right);
-                if (fabs(rightVal) < 0.000001f) {
-                    errorMessage = "Blad matematyczny: Dzielenie przez zero.";
-                    return NAN;
-                }
-                return leftVal / rightVal;
-            }
+unique_ptr<ExpressionNode> MathExpressionParser::parsePrimary() {
+    Token token = peek();
+
+    if (token.type == TOKEN_NUMBER) {
+        tokenPos++;
+        return make_unique<ExpressionNode>(NODE_CONSTANT, token.value);
     }
-    
-    // Mnożenie implikowane
-    int pCount = 0;
-        for (size_t i = 0; i < trimmed.length() - 1; i++) {
-            char c = trimmed[i];
-            if (c == '(') pCount++;
-            else if (c == ')') pCount--;
-
-            // Mnożenie sprawdzamy poza nawiasami funkcji
-            if (pCount == 0) {
-                char current = trimmed[i];
-                char next = trimmed[i + 1];
-
-                bool shouldMultiply = (isdigit(current) && (isalpha(next) || next == '(')) ||
-                                     (current == ')' && (isdigit(next) || isalpha(next) || next == '(')) ||
-                                     (current == 'x' && (isdigit(next) || isalpha(next) || next == '('));
-
-                if (shouldMultiply) {
-                    // Sprawdzenie, by nie rozbijać nazw funkcji (np. s-in)
-                    if (isalpha(current) && isalpha(next)) continue;
-
-                    string left = trimmed.substr(0, i + 1);
-                    string right = trimmed.substr(i + 1);
-                    return parseExpression(x, left) * parseExpression(x, right);
-                }
-            }
+    if (token.type == TOKEN_VARIABLE) {
+        tokenPos++;
+        return make_unique<ExpressionNode>(NODE_VARIABLE);
+    }
+    if (token.type == TOKEN_FUNCTION) {
+        tokenPos++;
+        if (peek().type != TOKEN_LPAREN) {
+            setError(PARSE_EXPECTED_LPAREN, peek().position, 1);
+            return nullptr;
         }
-    //Potęgowanie
-    size_t maxPos = string::npos;
-    parenCount = 0;
-    for (size_t i = trimmed.length() - 1; i > 0; i--) {
-        char c = trimmed[i];
-        if (c == ')') parenCount++;
-        else if (c == '(') parenCount--;
-        else if (parenCount == 0 && c == '^') {
-            maxPos = i;
-            break;
+        tokenPos++;
+        unique_ptr<ExpressionNode> argument = parseSum();
+        if (!argument) return nullptr;
+        if (peek().type != TOKEN_RPAREN) {
+            setError(PARSE_UNBALANCED_PARENS, peek().position, 1);
+            return nullptr;
         }
+        tokenPos++;
+        return make_unique<ExpressionNode>(token.function, std::move(argument));
     }
-
-    if (maxPos != string::npos) {
-        string left = trimmed.substr(0, maxPos);
-        string right = trimmed.substr(maxPos + 1);
-        float base = parseExpression(x, left);
-        float exponent = parseExpression(x, right);
-        
-        if (!errorMessage.empty() || isnan(base) || isnan(exponent)) return NAN;
-
-        if (base < 0 && fabs(exponent - round(exponent)) > 0.0001f) {
-            errorMessage = "Blad matematyczny: Potega niecalkowita z liczby ujemnej.";
-            return NAN;
+    if (token.type == TOKEN_LPAREN) {
+        tokenPos++;
+        unique_ptr<ExpressionNode> inner = parseSum();
+        if (!inner) return nullptr;
+        if (peek().type != TOKEN_RPAREN) {
+            setError(PARSE_UNBALANCED_PARENS, peek().position, 1);
+            return nullptr;
         }
-        return pow(base, exponent);
+        tokenPos++;
+        return inner;
     }
-    
-    
-    if (trimmed.find("ln(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 2);
-            if (match == trimmed.length() - 1) {
-                float val = parseExpression(x, trimmed.substr(3, trimmed.length() - 4));
-                if (val <= 0) { errorMessage = "Blad: logarytm <= 0"; return NAN; }
-                return log(val);
-            }
-        }
 
-        if (trimmed.find("log(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 3);
-            if (match == trimmed.length() - 1) {
-                float val = parseExpression(x, trimmed.substr(4, trimmed.length() - 5));
-                if (val <= 0) { errorMessage = "Blad: log() tylko dla liczb > 0."; return NAN; }
-                return log10(val);
-            }
-        }
-
-        if (trimmed.find("tan(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 3);
-            if (match == trimmed.length() - 1) {
-                float val = parseExpression(x, trimmed.substr(4, trimmed.length() - 5));
-                if (fabs(cos(val)) < 0.0001f) { errorMessage = "Blad: Asymptota tangensa."; return NAN; }
-                return tan(val);
-            }
-        }
-
-        if (trimmed.find("sin(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 3);
-            if (match == trimmed.length() - 1) {
-                return sin(parseExpression(x, trimmed.substr(4, trimmed.length() - 5)));
-            }
-        }
+    setError(PARSE_MISSING_OPERAND, token.position, 1);
+    return nullptr;
+}
 
-        if (trimmed.find("cos(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 3);
-            if (match == trimmed.length() - 1) {
-                return cos(parseExpression(x, trimmed.substr(4, trimmed.length() - 5)));
-            }
-        }
+void MathExpressionParser::compile() {
+    root.reset();
+    program.clear();
+    if (!tokenize(expression)) return;
 
-    if (trimmed.find("abs(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 3);
-            if (match == trimmed.length() - 1) {
-                string content = trimmed.substr(4, trimmed.length() - 5);
-                return fabs(parseExpression(x, content));
-            }
-        }
-    
-        if (trimmed.find("exp(") == 0 && trimmed.back() == ')') {
-            size_t match = findMatchingParen(trimmed, 3);
-            if (match == trimmed.length() - 1) {
-                return exp(parseExpression(x, trimmed.substr(4, trimmed.length() - 5)));
-            }
-        }
-        
-        if (trimmed.find("e^") == 0) {
-            return exp(parseExpression(x, trimmed.substr(2)));
-        }
+    tokenPos = 0;
+    unique_ptr<ExpressionNode> tree = parseSum();
+    if (tree && peek().type != TOKEN_END) {
+        setError(PARSE_UNEXPECTED_TOKEN, peek().position, 1);
+        tree.reset();
+    }
+    tokens.clear();
+    if (!tree) return;
 
-    if (trimmed == "x") return x;
-    if (trimmed == "-x") return -x;
-    if (trimmed == "e") return M_E;
-    if (trimmed == "pi") return M_PI;
+    tree = optimizeExpression(std::move(tree));
 
-    try {
-        return stof(trimmed);
-    } catch (...) {
-        errorMessage = "Blad parsowania: Nieznany symbol '" + trimmed + "'.";
-        return NAN;
+    if (!program.compile(*tree)) {
+        setError(PARSE_TOO_COMPLEX);
+        return;
     }
-}
 
-size_t MathExpressionParser::findMatchingParen(const string& str, size_t start) {
-    int count = 1;
-    for (size_t i = start + 1; i < str.length(); i++) {
-        if (str[i] == '(') count++;
-        else if (str[i] == ')') {
-            count--;
-            if (count == 0) return i;
+    // Czysty wielomian liczony jest Hornerem, bez interpretera
+    vector<double> coefficients;
+    if (parsePolynomial(*tree, coefficients)) {
+        program.setPolynomial(coefficients);
+        if (type == LINEAR || type == QUADRATIC || type == POLYNOMIAL) {
+            size_t degree = coefficients.size() - 1;
+            type = (degree <= 1) ? LINEAR : (degree == 2) ? QUADRATIC : POLYNOMIAL;
         }
     }
-    return str.length();
+    root = std::move(tree);
 }
 
 void MathExpressionParser::detectFunctionType() {
@@ -497,68 +583,139 @@ void MathExpressionParser::detectFunctionType() {
     if (contains(expr, "cot(")) { type = COT; return; }
     if (contains(expr, "log") || contains(expr, "ln(")) { type = LOGARITHMIC; return; }
     if (contains(expr, "x^2") && !contains(expr, "x^3")) { type = QUADRATIC; return; }
-    if (contains(expr, "x")) { parsePolynomial(expr); }
-    if (type == UNKNOWN) type = LINEAR;
+    type = POLYNOMIAL;
 }
 
 void MathExpressionParser::setExpression(const string& expr) {
     verticalLineX = 0.0f;
     horizontalLineY = 0.0f;
     isCircle = false;
-    polynomialTerms.clear();
     type = UNKNOWN;
-    errorMessage = "";
+    root.reset();
+    program.clear();
+    error = ParseError();
+    source = expr;
+    sourceIndex.clear();
 
     if (expr.empty()) {
-        errorMessage = "Wpisz rownanie funkcji.";
+        setError(PARSE_EMPTY);
         return;
     }
 
     string processed = removeWhitespace(toLower(expr));
+    for (size_t i = 0; i <= expr.length(); i++) {
+        if (i == expr.length() || !isspace(static_cast<unsigned char>(expr[i]))) sourceIndex.push_back(i);
+    }
 
     int pipeCount = 0;
     for (char c : processed) if (c == '|') pipeCount++;
     if (pipeCount % 2 != 0) {
-        errorMessage = "Blad: Niezamkniete znaki wartosci bezwzglednej |.";
+        setError(PARSE_UNBALANCED_ABS);
         return;
     }
 
     normalizeExpression(processed);
     expression = processed;
 
+    // Pozycja pierwszego nadmiarowego ')' albo koniec, gdy brakuje ')'
     int parenCount = 0;
-    for (char c : expression) {
-        if (c == '(') parenCount++;
-        else if (c == ')') parenCount--;
+    size_t parenError = expression.length();
+    for (size_t i = 0; i < expression.length() && parenCount >= 0; i++) {
+        if (expression[i] == '(') parenCount++;
+        else if (expression[i] == ')' && --parenCount < 0) parenError = i;
     }
     if (parenCount != 0) {
-        errorMessage = "Blad: Niezamkniete nawiasy.";
+        setError(PARSE_UNBALANCED_PARENS, parenError, 1);
         return;
     }
 
     detectFunctionType();
-    
-}
 
-float MathExpressionParser::evaluate(float x) {
-    if (!errorMessage.empty() && errorMessage.find("Blad matematyczny") == string::npos &&
-        errorMessage.find("Blad:") == string::npos) {
-        return NAN;
+    if (!error && !isCircle && expression != "horizontal" && expression != "vertical") {
+        compile();
+        // Stale bez x (np. y=pi, y=sin(1)) - wartosc liczona raz z drzewa
+        if (type == HORIZONTAL_LINE) {
+            horizontalLineY = root ? program.run(0.0f) : NAN;
+        }
     }
-    errorMessage = "";
+}
 
-    float result = parseExpression(x, expression);
-    if (!errorMessage.empty()) {
-        return NAN;
-    }
+float MathExpressionParser::evaluate(float x) const {
+    return program.run(x);
+}
 
-    return result;
+void MathExpressionParser::evaluateBatch(span<const float> xs, span<float> ys) const {
+    program.run(xs.data(), ys.data(), min(xs.size(), ys.size()));
+}
+
+void MathExpressionParser::evaluateBatch(span<const double> xs, span<double> ys) const {
+    program.run(xs.data(), ys.data(), min(xs.size(), ys.size()));
+}
+
+size_t MathExpressionParser::evaluateBatch(span<const float> xs, span<float> ys, span<bool> failed) const {
+    size_t count = min(xs.size(), ys.size());
+    program.run(xs.data(), ys.data(), count);
+
+    size_t failures = 0;
+    size_t marked = min(count, failed.size());
+    for (size_t i = 0; i < count; i++) {
+        bool nan = isnan(ys[i]);
+        if (i < marked) failed[i] = nan;
+        failures += nan;
+    }
+    return failures;
 }
 
+const ExpressionProgram& MathExpressionParser::getProgram() const { return program; }
+shared_ptr<const ExpressionNode> MathExpressionParser::getTree() const { return root; }
+
+string MathExpressionParser::dump() const {
+    if (!root) return "";
+    return dumpExpression(*root) + "\n" + program.dump();
+}
 FunctionType MathExpressionParser::getType() const { return type; }
 string MathExpressionParser::getExpression() const { return expression; }
 float MathExpressionParser::getVerticalLineX() const { return verticalLineX; }
 float MathExpressionParser::getHorizontalLineY() const { return horizontalLineY; }
 bool MathExpressionParser::isCircleEquation() const { return isCircle; }
 void MathExpressionParser::getCircleParams(float& cx, float& cy, float& r) const { cx = circleCenterX; cy = circleCenterY; r = circleRadius; }
-string MathExpressionParser::getErrorMessage() const { return errorMessage; }
+bool MathExpressionParser::hasError() const { return static_cast<bool>(error); }
+const ParseError& MathExpressionParser::getError() const { return error; }
+string MathExpressionParser::getErrorMessage(MessageLanguage language) const { return formatParseError(error, source, language); }
+
+// Liczba znaków innych niż spacje w text[0, end)
+static size_t countNonSpace(const string& text, size_t end) {
+    size_t count = 0;
+    for (size_t i = 0; i < min(end, text.length()); i++) {
+        if (!isspace(static_cast<unsigned char>(text[i]))) count++;
+    }
+    return count;
+}
+
+// Indeks znaku innego niż spacja o numerze n (od zera) albo text.length()
+static size_t findNonSpace(const string& text, size_t n) {
+    for (size_t i = 0; i < text.length(); i++) {
+        if (!isspace(static_cast<unsigned char>(text[i])) && n-- == 0) return i;
+    }
+    return text.length();
+}
+
+// Oba teksty mają te same znaki poza spacjami, więc fragment przenosimy,
+// licząc znaki bez spacji przed nim i w nim
+ParseError MathExpressionParser::getError(const string& text) const {
+    ParseError translated = error;
+    if (error.position == ParseError::NO_POSITION || text == source) return translated;
+
+    size_t before = countNonSpace(source, error.position);
+    translated.position = findNonSpace(text, before);
+    if (error.length > 0) {
+        size_t inside = countNonSpace(source, error.position + error.length) - before;
+        size_t end = inside > 0 ? findNonSpace(text, before + inside - 1) + 1 : translated.position;
+        translated.length = max(end, translated.position + 1) - translated.position;
+    }
+    return translated;
+}
+
+string MathExpressionParser::getErrorMessage(const string& text, MessageLanguage language) const {
+    return formatParseError(getError(text), text, language);
+}
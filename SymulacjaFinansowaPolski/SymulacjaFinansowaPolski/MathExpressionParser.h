@@ -2,8 +2,14 @@
 #define MATHEXPRESSIONPARSER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility>
+#include <memory>
+#include <span>
+#include "ExpressionNode.h"
+#include "ExpressionProgram.h"
+#include "ParseError.h"
 
 enum FunctionType {
     LINEAR,
@@ -25,39 +31,91 @@ enum FunctionType {
 
 class MathExpressionParser {
 private:
+    enum TokenType {
+        TOKEN_NUMBER,
+        TOKEN_VARIABLE,
+        TOKEN_FUNCTION,
+        TOKEN_OPERATOR,
+        TOKEN_LPAREN,
+        TOKEN_RPAREN,
+        TOKEN_END
+    };
+
+    struct Token {
+        TokenType type;
+        double value;
+        NodeKind function;
+        char op;
+        size_t position;
+    };
+
     std::string expression;
+    // Tekst wpisany przez użytkownika i, dla każdego znaku expression (plus
+    // pozycji za końcem), indeks znaku w source, z którego powstał
+    std::string source;
+    std::vector<size_t> sourceIndex;
     FunctionType type;
-    
-    std::vector<std::pair<float, float>> polynomialTerms;
+
+    std::shared_ptr<const ExpressionNode> root;
+    ExpressionProgram program;
+    std::vector<Token> tokens;
+    size_t tokenPos;
+
+    static const size_t MAX_POLYNOMIAL_DEGREE = 32;
 
     float verticalLineX;
     float horizontalLineY;
     float circleCenterX, circleCenterY, circleRadius;
     bool isCircle;
     
-    std::string errorMessage;
+    ParseError error;
 
     std::string removeWhitespace(const std::string& str);
     std::string toLower(const std::string& str);
     bool contains(const std::string& str, const std::string& substr);
     void replaceAll(std::string& str, const std::string& from, const std::string& to);
-    size_t findMatchingParen(const std::string& str, size_t start);
+    void replaceRange(std::string& str, size_t position, size_t length, const std::string& to);
     
     bool isValidCharacter(char c);
     void normalizeExpression(std::string& expr);
     void parseCircleEquation(const std::string& expr);
-    void parsePolynomial(const std::string& expr);
-    
-    float parseExpression(float x, const std::string& expr);
+    bool parsePolynomial(const ExpressionNode& node, std::vector<double>& coefficients);
     
+    static bool parseNumber(std::string_view text, float& value);
+    void setError(ParseErrorCode code, size_t position = ParseError::NO_POSITION, size_t length = 0);
+
+    bool tokenize(std::string_view expr);
+    const Token& peek() const;
+    bool startsOperand(const Token& token) const;
+    std::unique_ptr<ExpressionNode> parseSum();
+    std::unique_ptr<ExpressionNode> parseProduct();
+    std::unique_ptr<ExpressionNode> parseImplicitProduct();
+    std::unique_ptr<ExpressionNode> parseUnary();
+    std::unique_ptr<ExpressionNode> parsePower();
+    std::unique_ptr<ExpressionNode> parsePrimary();
+    void compile();
+
     void detectFunctionType();
 
 public:
     MathExpressionParser();
     void setExpression(const std::string& expr);
     
-    float evaluate(float x);
+    // evaluate(x) i evaluateBatch dla double liczą funkcje przez <cmath>,
+    // a evaluateBatch dla float przez jądra SIMD z VectorMath; wyniki dla
+    // tego samego x mogą się więc różnić o kilka ULP (granice w VectorMath.h)
+    float evaluate(float x) const;
+    void evaluateBatch(std::span<const float> xs, std::span<float> ys) const;
+    void evaluateBatch(std::span<const double> xs, std::span<double> ys) const;
+    // Jak wyżej, a dodatkowo failed[i] = true dla próbek poza dziedziną (NAN).
+    // Zwraca liczbę takich próbek; bufor failed dostarcza wywołujący.
+    size_t evaluateBatch(std::span<const float> xs, std::span<float> ys, std::span<bool> failed) const;
     
+    const ExpressionProgram& getProgram() const;
+    std::shared_ptr<const ExpressionNode> getTree() const;
+    // Postać po optymalizacji: drzewo i program, np. do sprawdzenia zwijania stałych
+    std::string dump() const;
+
     FunctionType getType() const;
     std::string getExpression() const;
     float getVerticalLineX() const;
@@ -65,7 +123,14 @@ public:
     bool isCircleEquation() const;
     void getCircleParams(float& cx, float& cy, float& r) const;
 
-    std::string getErrorMessage() const;
+    bool hasError() const;
+    const ParseError& getError() const;
+    std::string getErrorMessage(MessageLanguage language = LANGUAGE_POLISH) const;
+    // Błąd względem innego tekstu o tym samym kluczu ExpressionCache (inne
+    // tylko spacje i wielkość liter), np. gdy parser z pamięci podręcznej
+    // powstał z tekstu wpisanego wcześniej przez kogoś innego
+    ParseError getError(const std::string& text) const;
+    std::string getErrorMessage(const std::string& text, MessageLanguage language = LANGUAGE_POLISH) const;
 };
 
 #endif // MATHEXPRESSIONPARSER_H
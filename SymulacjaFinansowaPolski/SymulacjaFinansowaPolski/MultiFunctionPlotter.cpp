@@ -1,12 +1,20 @@
 #include "MultiFunctionPlotter.h"
 #include "MathExpressionParser.h"
-#include <GLFW/glfw3.h>
+#include "ExpressionCache.h"
+#include "GLHeaders.h"
 #include <cmath>
 #include <vector>
 
 using namespace std;
 
-MultiFunctionPlotter::MultiFunctionPlotter() : xMin(-10.0f), xMax(10.0f), resolution(2000), nextColorIndex(0) {
+SamplingStats::SamplingStats() : evaluations(0), resampledFunctions(0), skippedFunctions(0) {}
+
+MultiFunctionPlotter::MultiFunctionPlotter() : xMin(-10.0f), xMax(10.0f), pixelWidth(1400), pixelHeight(900),
+                                               yMin(-10.0f), yMax(10.0f), samplesPerPixel(1.0f), tolerancePixels(0.5f),
+                                               tileCacheCapacity(SampleTileCache::DEFAULT_CAPACITY),
+                                               viewportChanged(false), lastEvaluations(0), nextColorIndex(0), nextFunctionId(0),
+                                               requestVersion(0), jobPending(false), workerBusy(false),
+                                               resultReady(false), stopping(false), inCallback(false) {
     colorPalette = {
         ImVec4(0.0f, 0.8f, 1.0f, 1.0f),
         ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
@@ -17,125 +25,245 @@ MultiFunctionPlotter::MultiFunctionPlotter() : xMin(-10.0f), xMax(10.0f), resolu
         ImVec4(1.0f, 0.5f, 0.0f, 1.0f),
         ImVec4(0.5f, 0.5f, 1.0f, 1.0f)
     };
+    updateClipRect();
+    worker = thread(&MultiFunctionPlotter::workerLoop, this);
 }
 
-void MultiFunctionPlotter::updateFunction(int index) {
-    if (index < 0 || index >= (int)functions.size()) return;
+MultiFunctionPlotter::~MultiFunctionPlotter() {
+    {
+        lock_guard<mutex> lock(samplingMutex);
+        stopping = true;
+    }
+    jobReady.notify_one();
+    worker.join();
+}
 
-    auto& func = functions[index];
-    func.points.clear();
+// Wątek bierze zawsze najnowsze zlecenie (starsze, jeszcze nie rozpoczęte,
+// są nadpisywane) i publikuje wynik tylko wtedy, gdy w międzyczasie nie
+// przyszło nowsze. Łamane krążą między workerResult, completed
+// i FunctionData::curve, więc po rozgrzaniu nic nie jest alokowane.
+void MultiFunctionPlotter::workerLoop() {
+    unique_lock<mutex> lock(samplingMutex);
+    while (true) {
+        jobReady.wait(lock, [this] { return jobPending || stopping; });
+        if (stopping) return;
 
-    MathExpressionParser parser;
-    parser.setExpression(func.expression);
-    
-    if (!parser.getErrorMessage().empty() && parser.getType() == UNKNOWN) return;
+        swap(activeJob, pendingJob);
+        jobPending = false;
+        workerBusy = true;
+        lock.unlock();
 
-    // Linie pionowe
-    if (parser.getType() == VERTICAL_LINE) {
-        float xValue = parser.getVerticalLineX();
-        if (!isnan(xValue)) {
-            func.points.emplace_back(xValue, -1000.0f);
-            func.points.emplace_back(xValue, 1000.0f);
+        sampler.run(activeJob, workerResult);
+
+        lock.lock();
+        workerBusy = false;
+        bool published = false;
+        if (workerResult.version == requestVersion) {
+            swap(completed, workerResult);
+            resultReady = published = true;
         }
-        return;
-    }
+        jobDone.notify_all();
 
-    // Linie poziome
-    if (parser.getType() == HORIZONTAL_LINE) {
-        float yValue = parser.getHorizontalLineY();
-        if (!isnan(yValue)) {
-            func.points.emplace_back(xMin, yValue);
-            func.points.emplace_back(xMax, yValue);
+        if (published && resultCallback) {
+            // Bez blokady: wywołanie może czekać na wątek okna
+            function<void()> callback = resultCallback;
+            inCallback = true;
+            lock.unlock();
+            callback();
+            lock.lock();
+            inCallback = false;
+            jobDone.notify_all();
         }
-        return;
     }
+}
+
+void MultiFunctionPlotter::markAllDirty() {
+    for (auto& func : functions) func.dirty = true;
+}
+
+// Krzywe do rysowania są przycinane do widoku powiększonego o jego rozmiar
+// z każdej strony: przesunięcie w pionie w obrębie marginesu nie wymaga
+// ponownego przycinania. Prostokąt zmienia się tylko razem z próbkowaniem
+// wszystkich funkcji, więc wszystkie czyste funkcje mają ten sam.
+void MultiFunctionPlotter::updateClipRect() {
+    const float CLIP_MARGIN = 1.0f;
+    float marginX = (xMax - xMin) * CLIP_MARGIN, marginY = (yMax - yMin) * CLIP_MARGIN;
+    clipXMin = xMin - marginX;
+    clipXMax = xMax + marginX;
+    clipYMin = yMin - marginY;
+    clipYMax = yMax + marginY;
+}
 
-    // Okręgi
-    if (parser.isCircleEquation()) {
-        float cx, cy, r;
-        parser.getCircleParams(cx, cy, r);
-        int circlePoints = 360;
-        for (int i = 0; i <= circlePoints; i++) {
-            float angle = 2.0f * (float)M_PI * i / (float)circlePoints;
-            func.points.emplace_back(cx + r * cos(angle), cy + r * sin(angle));
+// Wołane po każdej zmianie, która oznaczyła funkcje jako brudne. Nowa wersja
+// unieważnia wynik w toku, dlatego zlecenie obejmuje wszystkie brudne
+// widoczne funkcje, także te z poprzedniego, jeszcze nie przejętego zlecenia.
+// Gdy takich nie ma, wątek nie jest budzony.
+void MultiFunctionPlotter::requestSampling() {
+    bool hasWork = false;
+    {
+        lock_guard<mutex> lock(samplingMutex);
+        requestVersion++;
+        pendingJob.version = requestVersion;
+        pendingJob.xMin = xMin;
+        pendingJob.xMax = xMax;
+        pendingJob.pixelWidth = pixelWidth;
+        pendingJob.pixelHeight = pixelHeight;
+        pendingJob.yMin = yMin;
+        pendingJob.yMax = yMax;
+        pendingJob.clipXMin = clipXMin;
+        pendingJob.clipXMax = clipXMax;
+        pendingJob.clipYMin = clipYMin;
+        pendingJob.clipYMax = clipYMax;
+        pendingJob.samplesPerPixel = samplesPerPixel;
+        pendingJob.tolerancePixels = tolerancePixels;
+        pendingJob.tileCacheCapacity = tileCacheCapacity;
+        pendingJob.ids.clear();
+        pendingJob.parsers.clear();
+        pendingJob.liveIds.clear();
+        for (const auto& func : functions) {
+            pendingJob.liveIds.push_back(func.id);
+            if (!func.dirty || !func.enabled) continue;
+            pendingJob.ids.push_back(func.id);
+            pendingJob.parsers.push_back(func.parser);
         }
-        return;
+        hasWork = !pendingJob.ids.empty();
+        jobPending = hasWork;
     }
+    if (hasWork) jobReady.notify_one();
+}
 
-    float step = (xMax - xMin) / (float)resolution;
-
-    for (int i = 0; i <= resolution; ++i) {
-            float x = xMin + i * step;
-            float y = parser.evaluate(x);
-
-        if (!isnan(y) && !isinf(y)) {
-            if (!func.points.empty() && !isnan(func.points.back().y)) {
-                if (fabs(y - func.points.back().y) > 1.9f) {
-                    func.points.emplace_back(NAN, NAN);
-                }
-            }
-            func.points.emplace_back(x, y);
-        } else {
-            if (!func.points.empty() && !isnan(func.points.back().x)) {
-                func.points.emplace_back(NAN, NAN);
-            }
-        }
+void MultiFunctionPlotter::updateAllFunctions() {
+    markAllDirty();
+    updateClipRect();
+    requestSampling();
+}
+
+void MultiFunctionPlotter::setResultCallback(function<void()> callback) {
+    unique_lock<mutex> lock(samplingMutex);
+    jobDone.wait(lock, [this] { return !inCallback; });
+    resultCallback = move(callback);
+}
+
+// Identyfikatory rosną w kolejności dodawania, więc functions i ids wyniku
+// są posortowane tak samo i wystarczy jedno przejście
+bool MultiFunctionPlotter::pollResults() {
+    frameStats = SamplingStats();
+    lock_guard<mutex> lock(samplingMutex);
+    if (!resultReady) return false;
+    resultReady = false;
+    if (completed.version != requestVersion) return false;
+
+    size_t f = 0;
+    for (size_t i = 0; i < completed.ids.size(); i++) {
+        while (f < functions.size() && functions[f].id < completed.ids[i]) f++;
+        if (f == functions.size()) break;
+        if (functions[f].id != completed.ids[i]) continue;
+        swap(functions[f].curve, completed.curves[i]);
+        swap(functions[f].rendered, completed.rendered[i]);
+        functions[f].revision++;
+        functions[f].dirty = false;
+        frameStats.resampledFunctions++;
     }
+    frameStats.evaluations = completed.evaluations;
+    frameStats.skippedFunctions = functions.size() - frameStats.resampledFunctions;
+    lastEvaluations = completed.evaluations;
+    return true;
 }
 
+void MultiFunctionPlotter::synchronize() {
+    {
+        unique_lock<mutex> lock(samplingMutex);
+        jobDone.wait(lock, [this] { return !jobPending && !workerBusy; });
+    }
+    pollResults();
+}
 
 void MultiFunctionPlotter::draw() {
-    for (auto& func : functions) {
-        if (!func.enabled || func.points.empty()) continue;
-        glColor3f(func.color.x, func.color.y, func.color.z);
-        glLineWidth(2.0f);
-
-        glBegin(GL_LINE_STRIP);
-        for (const auto& pt : func.points) {
-            if (isnan(pt.x) || isnan(pt.y)) {
-                glEnd();
-                glBegin(GL_LINE_STRIP);
-            } else {
-                glVertex2f(pt.x, pt.y);
-            }
-        }
-        glEnd();
-    }
-    glLineWidth(1.0f);
+    if (!lineRenderer.draw(functions)) renderer.draw(functions);
 }
 
+void MultiFunctionPlotter::releaseGraphics() {
+    lineRenderer.release();
+    renderer.release();
+}
+
+// Ten sam zakres przy niezmienionej rozdzielczości niczego nie zleca
 void MultiFunctionPlotter::setRange(float min, float max) {
+    if (min == xMin && max == xMax && !viewportChanged) return;
     xMin = min;
     xMax = max;
+    viewportChanged = false;
     updateAllFunctions();
 }
 
-void MultiFunctionPlotter::updateAllFunctions() {
-    for (size_t i = 0; i < functions.size(); i++) {
-        updateFunction((int)i);
-    }
+// Punkty zależą od rozmiaru w pikselach i od skali pionowej (upraszczanie
+// łamanej), a położenie widoku w pionie tylko przez przycinanie
+void MultiFunctionPlotter::setViewport(int width, int height, float bottom, float top) {
+    width = max(width, 1);
+    height = max(height, 1);
+    if (width != pixelWidth || height != pixelHeight || top - bottom != yMax - yMin) viewportChanged = true;
+    if (bottom < clipYMin || top > clipYMax) viewportChanged = true;
+    pixelWidth = width;
+    pixelHeight = height;
+    yMin = bottom;
+    yMax = top;
 }
 
-void MultiFunctionPlotter::addFunction(const string& equation) {
+void MultiFunctionPlotter::setAdaptiveSampling(float tolerance, float density) {
+    if (tolerance == tolerancePixels && density == samplesPerPixel) return;
+    tolerancePixels = tolerance;
+    samplesPerPixel = density;
+    updateAllFunctions();
+}
+
+void MultiFunctionPlotter::setTileCacheCapacity(size_t bytes) {
+    tileCacheCapacity = bytes;
+}
+
+void MultiFunctionPlotter::appendFunction(const string& equation) {
     ImVec4 color = colorPalette[nextColorIndex % colorPalette.size()];
     functions.emplace_back(equation, color);
+    functions.back().id = nextFunctionId++;
+    functions.back().parser = getExpressionCache().get(equation);
     nextColorIndex++;
-    updateFunction((int)functions.size() - 1);
+}
+
+void MultiFunctionPlotter::addFunction(const string& equation) {
+    appendFunction(equation);
+    requestSampling();
+}
+
+// Jedno zlecenie dla wszystkich: wątek nie zaczyna próbkować pierwszej
+// funkcji, żeby zaraz potem odrzucić wynik
+void MultiFunctionPlotter::addFunctions(const vector<string>& equations) {
+    for (const string& equation : equations) appendFunction(equation);
+    requestSampling();
 }
 
 void MultiFunctionPlotter::editFunction(int index, const string& newEquation) {
     if (index >= 0 && index < (int)functions.size()) {
         functions[index].expression = newEquation;
-        updateFunction(index);
+        functions[index].parser = getExpressionCache().get(newEquation);
+        functions[index].dirty = true;
+        requestSampling();
     }
 }
 
+// Pozostałe funkcje są aktualne; kafelki usuniętej sampler zwalnia przy
+// następnym zleceniu
 void MultiFunctionPlotter::removeFunction(int index) {
     if (index >= 0 && index < (int)functions.size()) {
         functions.erase(functions.begin() + index);
     }
 }
 
+// Włączenie funkcji, która przegapiła zmiany jako ukryta, zleca jej próbkowanie
+void MultiFunctionPlotter::setFunctionEnabled(int index, bool enabled) {
+    if (index < 0 || index >= (int)functions.size() || functions[index].enabled == enabled) return;
+    functions[index].enabled = enabled;
+    if (enabled && functions[index].dirty) requestSampling();
+}
+
 void MultiFunctionPlotter::clear() {
     functions.clear();
     nextColorIndex = 0;
@@ -145,3 +273,5 @@ vector<FunctionData>& MultiFunctionPlotter::getFunctions() { return functions; }
 float MultiFunctionPlotter::getXMin() const { return xMin; }
 float MultiFunctionPlotter::getXMax() const { return xMax; }
 void MultiFunctionPlotter::getRange(float& min, float& max) const { min = xMin; max = xMax; }
+size_t MultiFunctionPlotter::getLastEvaluationCount() const { return lastEvaluations; }
+const SamplingStats& MultiFunctionPlotter::getFrameStats() const { return frameStats; }
@@ -3,31 +3,103 @@
 
 #include <vector>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include "FunctionData.h"
+#include "FunctionSampler.h"
+#include "CurveRenderer.h"
+#include "ThickLineRenderer.h"
 #include "imgui.h"
 
+// Liczniki ostatniej ramki: ile wartości policzono i ile funkcji dostało
+// nowe punkty w pollResults(); w ramce bez wyniku wszystko jest zerem
+struct SamplingStats {
+    size_t evaluations;
+    size_t resampledFunctions;
+    size_t skippedFunctions;        // czyste albo ukryte, punkty bez zmian
+
+    SamplingStats();
+};
+
+// Funkcje na wykresie. Próbkowanie odbywa się w osobnym wątku: każda zmiana
+// widoku lub funkcji oznacza dotknięte funkcje jako brudne i zleca nowe
+// próbkowanie (z kolejnym numerem wersji) tylko tych brudnych, które są
+// widoczne; ukryte czekają, aż zostaną włączone. pollResults() w wątku
+// rysującym podmienia punkty funkcji na gotowe. Wyniki zlecone przed
+// późniejszą zmianą są odrzucane.
 class MultiFunctionPlotter {
 private:
     std::vector<FunctionData> functions;
     float xMin, xMax;
-    int resolution;
+    int pixelWidth, pixelHeight;    // rozmiar bufora ramki w pikselach urządzenia
+    float yMin, yMax;
+    float samplesPerPixel;          // docelowa gęstość próbek w najdrobniejszym podziale
+    float tolerancePixels;          // dopuszczalne odejście środka od cięciwy
+    size_t tileCacheCapacity;       // limit pamięci kafelków na funkcję, w bajtach
+    float clipXMin, clipXMax, clipYMin, clipYMax;  // przycinanie bieżących krzywych
+    bool viewportChanged;           // setViewport zmienił rozdzielczość lub wyszedł poza clip*, czeka na setRange
+    size_t lastEvaluations;
+    SamplingStats frameStats;
+    ThickLineRenderer lineRenderer;
+    CurveRenderer renderer;         // gdy shadery są niedostępne
     std::vector<ImVec4> colorPalette;
     int nextColorIndex;
+    unsigned nextFunctionId;
+
+    // Wątek próbkujący. pendingJob, completed i flagi chroni samplingMutex;
+    // sampler, activeJob i workerResult należą wyłącznie do wątku.
+    FunctionSampler sampler;
+    SamplingJob activeJob;
+    SamplingResult workerResult;
+    std::mutex samplingMutex;
+    std::condition_variable jobReady, jobDone;
+    SamplingJob pendingJob;
+    SamplingResult completed;
+    unsigned requestVersion;
+    bool jobPending, workerBusy, resultReady, stopping;
+    bool inCallback;        // wątek wykonuje resultCallback poza blokadą
+    std::function<void()> resultCallback;
+    std::thread worker;
+
+    void workerLoop();
+    void markAllDirty();
+    void updateClipRect();
+    void requestSampling();
+    void appendFunction(const std::string& equation);
 
 public:
     MultiFunctionPlotter();
+    ~MultiFunctionPlotter();
+    MultiFunctionPlotter(const MultiFunctionPlotter&) = delete;
+    MultiFunctionPlotter& operator=(const MultiFunctionPlotter&) = delete;
+
     void addFunction(const std::string& equation);
+    void addFunctions(const std::vector<std::string>& equations);
     void editFunction(int index, const std::string& newEquation);
     void removeFunction(int index);
-    void updateFunction(int index);
-    void updateAllFunctions();
+    void setFunctionEnabled(int index, bool enabled);
+    void updateAllFunctions();      // wymusza ponowne próbkowanie wszystkich funkcji
+    bool pollResults();             // true, gdy podmieniono punkty
+    // Wołana w wątku próbkującym po opublikowaniu wyniku, np. żeby obudzić pętlę zdarzeń.
+    // Czeka na zakończenie trwającego wywołania, więc po setResultCallback(nullptr)
+    // stara funkcja już się nie wykonuje; nie wolno jej wołać z samej funkcji.
+    void setResultCallback(std::function<void()> callback);
+    void synchronize();             // czeka na ostatnie zlecenie i przejmuje wynik
     void draw();
+    void releaseGraphics();         // przed zniszczeniem kontekstu GL
     void clear();
     void setRange(float min, float max);
+    void setViewport(int width, int height, float bottom, float top);
+    void setAdaptiveSampling(float tolerance, float density);
+    void setTileCacheCapacity(size_t bytes);
+    size_t getLastEvaluationCount() const;
+    const SamplingStats& getFrameStats() const;
     std::vector<FunctionData>& getFunctions();
     float getXMin() const;
     float getXMax() const;
     void getRange(float& min, float& max) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,46 @@
+#include "ParseError.h"
+
+using namespace std;
+
+struct ErrorText {
+    const char* polish;
+    const char* english;
+    bool quoteSpan;
+};
+
+// Kolejność jak w ParseErrorCode
+static const ErrorText errorTexts[] = {
+    { "", "", false },
+    { "Wpisz rownanie funkcji", "Enter a function equation", false },
+    { "Blad parsowania: Nieznany symbol", "Parse error: Unknown symbol", true },
+    { "Blad parsowania: Niepoprawna liczba", "Parse error: Invalid number", true },
+    { "Blad parsowania: Oczekiwano '(' po nazwie funkcji", "Parse error: Expected '(' after function name", false },
+    { "Blad: Niezamkniete nawiasy", "Error: Unbalanced parentheses", false },
+    { "Blad: Niezamkniete znaki wartosci bezwzglednej |", "Error: Unbalanced absolute value bars |", false },
+    { "Blad parsowania: Brak argumentu operatora", "Parse error: Missing operand", false },
+    { "Blad parsowania: Nieoczekiwany znak w wyrazeniu", "Parse error: Unexpected character in expression", false },
+    { "Blad: Wyrazenie jest zbyt zlozone", "Error: Expression is too complex", false },
+    { "Blad parsowania rownania okregu", "Error parsing circle equation", false },
+    { "Blad: Ujemny promien ($R^2 < 0$) dla rownania okregu", "Error: Negative radius ($R^2 < 0$) in circle equation", false }
+};
+
+string formatParseError(const ParseError& error, string_view expression, MessageLanguage language) {
+    if (!error) return "";
+
+    const ErrorText& text = errorTexts[error.code];
+    string message = (language == LANGUAGE_ENGLISH) ? text.english : text.polish;
+
+    bool hasSpan = error.position != ParseError::NO_POSITION && error.position <= expression.length();
+    if (text.quoteSpan && hasSpan && error.length > 0) {
+        message += " '";
+        message += expression.substr(error.position, error.length);
+        message += "'";
+    }
+    if (hasSpan) {
+        message += (language == LANGUAGE_ENGLISH) ? " (at " : " (znak ";
+        message += to_string(error.position + 1);
+        message += ")";
+    }
+    message += ".";
+    return message;
+}
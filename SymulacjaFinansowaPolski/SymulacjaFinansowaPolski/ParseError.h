@@ -0,0 +1,45 @@
+#ifndef PARSEERROR_H
+#define PARSEERROR_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+enum ParseErrorCode {
+    PARSE_OK,
+    PARSE_EMPTY,
+    PARSE_UNKNOWN_SYMBOL,
+    PARSE_INVALID_NUMBER,
+    PARSE_EXPECTED_LPAREN,
+    PARSE_UNBALANCED_PARENS,
+    PARSE_UNBALANCED_ABS,
+    PARSE_MISSING_OPERAND,
+    PARSE_UNEXPECTED_TOKEN,
+    PARSE_TOO_COMPLEX,
+    PARSE_CIRCLE_SYNTAX,
+    PARSE_NEGATIVE_RADIUS
+};
+
+enum MessageLanguage {
+    LANGUAGE_POLISH,
+    LANGUAGE_ENGLISH
+};
+
+// Błąd parsowania: kod i fragment wyrażenia (w tekście wpisanym przez
+// użytkownika, razem ze spacjami), którego dotyczy.
+// position == NO_POSITION oznacza błąd całego wyrażenia.
+struct ParseError {
+    static const size_t NO_POSITION = static_cast<size_t>(-1);
+
+    ParseErrorCode code = PARSE_OK;
+    size_t position = NO_POSITION;
+    size_t length = 0;
+
+    explicit operator bool() const { return code != PARSE_OK; }
+};
+
+// Tekst komunikatu składany dopiero na żądanie (np. przy wyświetlaniu)
+std::string formatParseError(const ParseError& error, std::string_view expression,
+                             MessageLanguage language = LANGUAGE_POLISH);
+
+#endif // PARSEERROR_H
@@ -0,0 +1,254 @@
+#include "PngWriter.h"
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+
+using namespace std;
+
+static const int WINDOW_SIZE = 32768;       // największa odległość w deflate
+static const int HASH_BITS = 15;
+static const int MIN_MATCH = 3;
+static const int MAX_MATCH = 258;
+static const int MAX_CHAIN = 16;            // ile wcześniejszych pozycji sprawdzamy
+static const int MAX_INSERT = 16;           // dłuższe dopasowania nie trafiają do haszu
+
+static const int LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                     35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const int LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const int DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                       257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                       8193, 12289, 16385, 24577 };
+static const int DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+    static const auto table = [] {
+        static uint32_t values[256];
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            values[n] = c;
+        }
+        return values;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t adler32(const vector<unsigned char>& data) {
+    uint32_t a = 1, b = 0;
+    size_t i = 0;
+    while (i < data.size()) {
+        // 5552 bajtów nie przepełnia b przed redukcją
+        size_t end = min(data.size(), i + 5552);
+        for (; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void putBigEndian(vector<unsigned char>& out, uint32_t value) {
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+static void putChunk(vector<unsigned char>& file, const char* type, const unsigned char* data, size_t size) {
+    putBigEndian(file, (uint32_t)size);
+    size_t typeStart = file.size();
+    file.insert(file.end(), type, type + 4);
+    file.insert(file.end(), data, data + size);
+    putBigEndian(file, crc32(file.data() + typeStart, size + 4));
+}
+
+PngWriter::PngWriter() : bitBuffer(0), bitCount(0) {}
+
+void PngWriter::filterRows(const unsigned char* rgb, int width, int height) {
+    size_t stride = (size_t)width * 3;
+    filtered.resize((stride + 1) * height);
+
+    for (int row = 0; row < height; row++) {
+        const unsigned char* current = rgb + row * stride;
+        const unsigned char* above = row > 0 ? current - stride : current;
+        unsigned char* out = &filtered[row * (stride + 1)];
+
+        // Suma modułów reszt jako bajtów ze znakiem dla None, Sub i Up;
+        // w pierwszym wierszu Up nie ma sensu (dałby zera)
+        // (pierwszy piksel osobno, żeby pętla się wektoryzowała)
+        long long costNone = 0, costSub = 0, costUp = 0;
+        for (size_t i = 0; i < 3; i++) {
+            costNone += abs((signed char)current[i]);
+            costSub += abs((signed char)current[i]);
+            costUp += abs((signed char)(current[i] - above[i]));
+        }
+        for (size_t i = 3; i < stride; i++) {
+            costNone += abs((signed char)current[i]);
+            costSub += abs((signed char)(current[i] - current[i - 3]));
+            costUp += abs((signed char)(current[i] - above[i]));
+        }
+        if (row == 0) costUp = LLONG_MAX;
+
+        if (costUp <= costNone && costUp <= costSub) {
+            out[0] = 2;
+            for (size_t i = 0; i < stride; i++) out[i + 1] = (unsigned char)(current[i] - above[i]);
+        } else if (costSub < costNone) {
+            out[0] = 1;
+            memcpy(out + 1, current, 3);
+            for (size_t i = 3; i < stride; i++) out[i + 1] = (unsigned char)(current[i] - current[i - 3]);
+        } else {
+            out[0] = 0;
+            memcpy(out + 1, current, stride);
+        }
+    }
+}
+
+void PngWriter::putBits(unsigned value, int count) {
+    bitBuffer |= (unsigned long long)value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8) {
+        compressed.push_back((unsigned char)bitBuffer);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+// Kody Huffmana zapisuje się od najstarszego bitu
+void PngWriter::putReversed(unsigned code, int length) {
+    unsigned reversed = 0;
+    for (int i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+    putBits(reversed, length);
+}
+
+// Stałe kody deflate (RFC 1951, 3.2.6)
+void PngWriter::putLiteral(int symbol) {
+    if (symbol < 144) putReversed(0x30 + symbol, 8);
+    else if (symbol < 256) putReversed(0x190 + symbol - 144, 9);
+    else if (symbol < 280) putReversed(symbol - 256, 7);
+    else putReversed(0xC0 + symbol - 280, 8);
+}
+
+void PngWriter::putMatch(int length, int distance) {
+    int code = 28;
+    while (LENGTH_BASE[code] > length) code--;
+    putLiteral(257 + code);
+    putBits(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASE[code] > distance) code--;
+    putReversed(code, 5);
+    putBits(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+// Długość wspólnego początku a i b, najwyżej limit; po 8 bajtów naraz,
+// końcówka różniącego się słowa bajt po bajcie
+static int matchLength(const unsigned char* a, const unsigned char* b, int limit) {
+    int length = 0;
+    while (length + 8 <= limit) {
+        uint64_t x, y;
+        memcpy(&x, a + length, 8);
+        memcpy(&y, b + length, 8);
+        if (x != y) break;
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) length++;
+    return length;
+}
+
+// Jeden blok ze stałymi kodami; dopasowania zachłanne, najdłuższe
+// z MAX_CHAIN ostatnich pozycji o tym samym haszu trzech bajtów.
+// Jak w szybkich poziomach zlib pozycje wewnątrz długich dopasowań
+// (tło, całe puste wiersze) nie są dodawane do haszu.
+void PngWriter::deflate() {
+    compressed.clear();
+    compressed.push_back(0x78);     // zlib: deflate, okno 32 KiB
+    compressed.push_back(0x01);
+    bitBuffer = 0;
+    bitCount = 0;
+    putBits(1, 1);                  // ostatni blok
+    putBits(1, 2);                  // stałe kody Huffmana
+
+    head.assign(1 << HASH_BITS, -1);
+    chain.assign(WINDOW_SIZE, -1);
+    const unsigned char* data = filtered.data();
+    int size = (int)filtered.size();
+    auto hashAt = [data](int pos) {
+        uint32_t value = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+        return (int)((value * 2654435761u) >> (32 - HASH_BITS));
+    };
+    auto insert = [&](int pos) {
+        if (pos + MIN_MATCH > size) return;
+        int hash = hashAt(pos);
+        chain[pos & (WINDOW_SIZE - 1)] = head[hash];
+        head[hash] = pos;
+    };
+
+    int pos = 0;
+    while (pos < size) {
+        int bestLength = 0, bestDistance = 0;
+        if (pos + MIN_MATCH <= size) {
+            int limit = min(MAX_MATCH, size - pos);
+            int candidate = head[hashAt(pos)];
+            for (int probe = 0; probe < MAX_CHAIN && candidate >= 0 && pos - candidate <= WINDOW_SIZE; probe++) {
+                int length = matchLength(data + candidate, data + pos, limit);
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = pos - candidate;
+                    if (length == limit) break;
+                }
+                candidate = chain[candidate & (WINDOW_SIZE - 1)];
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            putMatch(bestLength, bestDistance);
+            if (bestLength <= MAX_INSERT) {
+                for (int i = 0; i < bestLength; i++) insert(pos + i);
+            } else {
+                insert(pos);
+                insert(pos + bestLength - 1);
+            }
+            pos += bestLength;
+        } else {
+            putLiteral(data[pos]);
+            insert(pos);
+            pos++;
+        }
+    }
+    putLiteral(256);
+    if (bitCount > 0) putBits(0, 8 - bitCount);
+    putBigEndian(compressed, adler32(filtered));
+}
+
+bool PngWriter::write(const string& path, int width, int height, const vector<unsigned char>& rgb) {
+    if (width <= 0 || height <= 0 || rgb.size() < (size_t)width * height * 3) return false;
+
+    filterRows(rgb.data(), width, height);
+    deflate();
+
+    vector<unsigned char> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    vector<unsigned char> header;
+    putBigEndian(header, (uint32_t)width);
+    putBigEndian(header, (uint32_t)height);
+    header.push_back(8);        // bitów na kanał
+    header.push_back(2);        // RGB
+    header.push_back(0);        // deflate
+    header.push_back(0);        // filtry adaptacyjne
+    header.push_back(0);        // bez przeplotu
+    putChunk(file, "IHDR", header.data(), header.size());
+    putChunk(file, "IDAT", compressed.data(), compressed.size());
+    putChunk(file, "IEND", nullptr, 0);
+
+    ofstream out(path, ios::binary);
+    if (!out) return false;
+    out.write((const char*)file.data(), file.size());
+    return (bool)out;
+}
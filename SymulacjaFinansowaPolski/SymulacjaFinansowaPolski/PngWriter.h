@@ -0,0 +1,34 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <string>
+#include <vector>
+
+// Zapis obrazu RGB (8 bitów na kanał, wiersze od góry) do pliku PNG bez
+// zewnętrznych bibliotek. Każdy wiersz dostaje filtr PNG (None, Sub albo Up)
+// o najmniejszej sumie modułów, a całość jest kompresowana deflate
+// ze stałymi kodami Huffmana i dopasowaniami LZ77 z tablicy haszującej.
+// Wykresy to głównie jednolite tło i cienkie linie, więc pliki są tylko
+// o około jedną trzecią większe niż z zlib, a koder jest krótki i szybki.
+class PngWriter {
+private:
+    std::vector<unsigned char> filtered;    // wiersze z bajtem filtra na początku
+    std::vector<unsigned char> compressed;  // strumień zlib
+    std::vector<int> head, chain;           // LZ77: ostatnia i poprzednia pozycja haszu
+    unsigned long long bitBuffer;
+    int bitCount;
+
+    void filterRows(const unsigned char* rgb, int width, int height);
+    void deflate();
+    void putBits(unsigned value, int count);
+    void putReversed(unsigned code, int length);
+    void putLiteral(int symbol);
+    void putMatch(int length, int distance);
+
+public:
+    PngWriter();
+
+    bool write(const std::string& path, int width, int height, const std::vector<unsigned char>& rgb);
+};
+
+#endif // PNGWRITER_H
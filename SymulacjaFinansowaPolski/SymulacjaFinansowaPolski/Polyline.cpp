@@ -0,0 +1,130 @@
+#include "Polyline.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+Polyline::Polyline() : open(false) {}
+
+void Polyline::clear() {
+    x.clear();
+    y.clear();
+    segments.clear();
+    open = false;
+}
+
+bool Polyline::empty() const {
+    return x.empty();
+}
+
+size_t Polyline::size() const {
+    return x.size();
+}
+
+void Polyline::append(float px, float py) {
+    if (!open) {
+        segments.push_back({ (unsigned)x.size(), (unsigned)x.size() });
+        open = true;
+    }
+    x.push_back(px);
+    y.push_back(py);
+    segments.back().end++;
+}
+
+void Polyline::replaceLast(float px, float py) {
+    x.back() = px;
+    y.back() = py;
+}
+
+void Polyline::breakSegment() {
+    open = false;
+}
+
+size_t Polyline::openLength() const {
+    return open ? segments.back().end - segments.back().begin : 0;
+}
+
+// Liang-Barsky: część [t0, t1] odcinka a-b leżąca w prostokącie
+static bool clipLine(float ax, float ay, float bx, float by, float xMin, float xMax, float yMin, float yMax,
+                     float& t0, float& t1) {
+    float dx = bx - ax, dy = by - ay;
+    float p[4] = { -dx, dx, -dy, dy };
+    float q[4] = { ax - xMin, xMax - ax, ay - yMin, yMax - ay };
+    t0 = 0.0f;
+    t1 = 1.0f;
+    for (int k = 0; k < 4; k++) {
+        if (p[k] == 0.0f) {
+            if (q[k] < 0.0f) return false;
+            continue;
+        }
+        float t = q[k] / p[k];
+        if (p[k] < 0.0f) t0 = max(t0, t);
+        else t1 = min(t1, t);
+    }
+    return t0 <= t1;
+}
+
+bool clipPolyline(const Polyline& in, float xMin, float xMax, float yMin, float yMax, Polyline& out) {
+    bool inside = true;
+    for (size_t i = 0; i < in.size() && inside; i++) {
+        inside = in.x[i] >= xMin && in.x[i] <= xMax && in.y[i] >= yMin && in.y[i] <= yMax;
+    }
+    if (inside) return false;
+
+    out.clear();
+    for (const PolylineSegment& segment : in.segments) {
+        if (segment.end - segment.begin == 1) {
+            unsigned i = segment.begin;
+            if (in.x[i] >= xMin && in.x[i] <= xMax && in.y[i] >= yMin && in.y[i] <= yMax) out.append(in.x[i], in.y[i]);
+            out.breakSegment();
+            continue;
+        }
+        // connected: poprzedni kawałek dotarł do końca swojego odcinka
+        // w prostokącie, więc ten zaczyna się w ostatnim dodanym punkcie
+        bool connected = false;
+        for (unsigned i = segment.begin; i + 1 < segment.end; i++) {
+            float ax = in.x[i], ay = in.y[i], bx = in.x[i + 1], by = in.y[i + 1];
+            float t0, t1;
+            if (!clipLine(ax, ay, bx, by, xMin, xMax, yMin, yMax, t0, t1)) {
+                connected = false;
+                continue;
+            }
+            if (!connected || t0 > 0.0f) {
+                out.breakSegment();
+                out.append(ax + (bx - ax) * t0, ay + (by - ay) * t0);
+            }
+            if (t1 < 1.0f) out.append(ax + (bx - ax) * t1, ay + (by - ay) * t1);
+            else out.append(bx, by);
+            connected = t1 == 1.0f;
+        }
+        out.breakSegment();
+    }
+    return true;
+}
+
+void decimatePixelColumns(const Polyline& in, float xMin, float xMax, int columns, Polyline& out) {
+    out.clear();
+    double scale = columns / ((double)xMax - xMin);
+    auto column = [&](float px) { return (long long)floor((px - (double)xMin) * scale); };
+
+    for (const PolylineSegment& segment : in.segments) {
+        unsigned i = segment.begin;
+        while (i < segment.end) {
+            long long col = column(in.x[i]);
+            unsigned first = i, low = i, high = i;
+            for (i++; i < segment.end && column(in.x[i]) == col; i++) {
+                if (in.y[i] < in.y[low]) low = i;
+                if (in.y[i] > in.y[high]) high = i;
+            }
+            unsigned last = i - 1;
+
+            // Po kolei według indeksu, bez powtórzeń
+            unsigned picks[4] = { first, min(low, high), max(low, high), last };
+            for (int k = 0; k < 4; k++) {
+                if (k > 0 && picks[k] == picks[k - 1]) continue;
+                out.append(in.x[picks[k]], in.y[picks[k]]);
+            }
+        }
+        out.breakSegment();
+    }
+}
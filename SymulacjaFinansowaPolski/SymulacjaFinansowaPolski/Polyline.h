@@ -0,0 +1,48 @@
+#ifndef POLYLINE_H
+#define POLYLINE_H
+
+#include <cstddef>
+#include <vector>
+
+// Zakres [begin, end) indeksów punktów jednego ciągłego odcinka łamanej
+struct PolylineSegment {
+    unsigned begin, end;
+};
+
+// Łamana z przerwami w układzie struktur tablic: współrzędne w osobnych,
+// ciągłych tablicach x i y, a nieciągłości opisuje lista odcinków zamiast
+// punktów (NAN, NAN). Rysowanie i analiza przechodzą po zwykłych tablicach
+// bez sprawdzania każdego punktu.
+struct Polyline {
+    std::vector<float> x, y;
+    std::vector<PolylineSegment> segments;
+
+    Polyline();
+    void clear();
+    bool empty() const;
+    size_t size() const;
+    void append(float px, float py);    // dokłada punkt do otwartego odcinka (lub otwiera nowy)
+    void replaceLast(float px, float py);
+    void breakSegment();                // następny punkt zacznie nowy odcinek
+    size_t openLength() const;          // liczba punktów otwartego odcinka
+
+private:
+    bool open;
+};
+
+// Przycina łamaną do prostokąta [xMin, xMax] x [yMin, yMax]: z odcinków
+// wychodzących poza prostokąt zostają punkty przecięcia z brzegiem, a każdy
+// wyjazd poza prostokąt zamyka odcinek. Zwraca false i nie rusza out, gdy
+// cała łamana mieści się w prostokącie.
+bool clipPolyline(const Polyline& in, float xMin, float xMax, float yMin, float yMax, Polyline& out);
+
+// Redukcja M4: każdy ciąg kolejnych punktów odcinka w jednej kolumnie
+// pikseli zastępuje pierwszym, najniższym, najwyższym i ostatnim punktem.
+// Zakres [xMin, xMax] ma columns kolumn; punkty spoza niego trafiają do
+// dalszych kolumn tej samej szerokości. Dla wykresu funkcji (x rosnące)
+// leżącego w zakresie, np. po clipPolyline, wynik ma najwyżej 4 * columns
+// punktów plus 4 na każdą przerwę i po rasteryzacji pokrywa te same piksele
+// co cała łamana.
+void decimatePixelColumns(const Polyline& in, float xMin, float xMax, int columns, Polyline& out);
+
+#endif
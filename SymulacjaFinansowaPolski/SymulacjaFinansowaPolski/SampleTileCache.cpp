@@ -0,0 +1,68 @@
+#include "SampleTileCache.h"
+#include <functional>
+
+using namespace std;
+
+size_t SampleTileCache::KeyHash::operator()(const Key& key) const {
+    return hash<long long>()(key.index) * 31 + hash<int>()(key.level);
+}
+
+SampleTileCache::SampleTileCache(size_t capacity) : bytes(0), capacity(capacity), pass(0) {}
+
+// Przybliżony koszt kafelka: punkty, węzeł listy i wpis indeksu
+size_t SampleTileCache::tileBytes(const SampleTile& tile) {
+    return sizeof(SampleTile) + tile.points.capacity() * sizeof(Point) + sizeof(Key) + 4 * sizeof(void*);
+}
+
+void SampleTileCache::beginPass() {
+    pass++;
+}
+
+const SampleTile* SampleTileCache::find(int level, long long tileIndex) {
+    auto it = index.find({ level, tileIndex });
+    if (it == index.end()) return nullptr;
+    tiles.splice(tiles.begin(), tiles, it->second);
+    it->second->lastUse = pass;
+    return &*it->second;
+}
+
+bool SampleTileCache::contains(int level, long long tileIndex) const {
+    return index.count({ level, tileIndex }) != 0;
+}
+
+void SampleTileCache::insert(int level, long long tileIndex, vector<Point>&& points) {
+    auto it = index.find({ level, tileIndex });
+    if (it != index.end()) {
+        bytes -= tileBytes(*it->second);
+        tiles.erase(it->second);
+        index.erase(it);
+    }
+
+    tiles.push_front({ level, tileIndex, pass, std::move(points) });
+    index[{ level, tileIndex }] = tiles.begin();
+    bytes += tileBytes(tiles.front());
+    evict();
+}
+
+void SampleTileCache::evict() {
+    while (bytes > capacity && !tiles.empty() && tiles.back().lastUse != pass) {
+        const SampleTile& tile = tiles.back();
+        bytes -= tileBytes(tile);
+        index.erase({ tile.level, tile.index });
+        tiles.pop_back();
+    }
+}
+
+void SampleTileCache::setCapacity(size_t newCapacity) {
+    capacity = newCapacity;
+    evict();
+}
+
+void SampleTileCache::clear() {
+    tiles.clear();
+    index.clear();
+    bytes = 0;
+}
+
+size_t SampleTileCache::size() const { return tiles.size(); }
+size_t SampleTileCache::memoryUsage() const { return bytes; }
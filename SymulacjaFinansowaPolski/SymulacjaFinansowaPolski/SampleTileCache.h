@@ -0,0 +1,63 @@
+#ifndef SAMPLETILECACHE_H
+#define SAMPLETILECACHE_H
+
+#include <cstddef>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include "Point.h"
+
+// Kafelek piramidy próbek: poziom L pokrywa oś x kafelkami szerokości 2^L,
+// kafelek index to przedział [index * 2^L, (index+1) * 2^L]. Punkty idą od
+// węzła lewego do prawego włącznie, razem z przerwami (NAN, NAN).
+struct SampleTile {
+    int level;
+    long long index;
+    unsigned lastUse;
+    std::vector<Point> points;
+};
+
+// Próbki jednej funkcji na wszystkich poziomach piramidy, z wypieraniem
+// najdawniej używanych kafelków (LRU) po przekroczeniu limitu pamięci.
+// Kafelki użyte w bieżącym przebiegu (beginPass) nie są wypierane, nawet
+// gdy sam widok przekracza limit.
+class SampleTileCache {
+private:
+    struct Key {
+        int level;
+        long long index;
+        bool operator==(const Key& other) const { return level == other.level && index == other.index; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    std::list<SampleTile> tiles;    // od najświeższego
+    std::unordered_map<Key, std::list<SampleTile>::iterator, KeyHash> index;
+    size_t bytes, capacity;
+    unsigned pass;
+
+    static size_t tileBytes(const SampleTile& tile);
+    void evict();
+
+public:
+    static const size_t DEFAULT_CAPACITY = 1 << 20;     // bajtów na funkcję
+
+    explicit SampleTileCache(size_t capacity = DEFAULT_CAPACITY);
+    SampleTileCache(SampleTileCache&&) noexcept = default;
+    SampleTileCache& operator=(SampleTileCache&&) noexcept = default;
+    SampleTileCache(const SampleTileCache&) = delete;
+    SampleTileCache& operator=(const SampleTileCache&) = delete;
+
+    void beginPass();
+    const SampleTile* find(int level, long long index);     // oznacza kafelek jako użyty
+    bool contains(int level, long long index) const;
+    void insert(int level, long long index, std::vector<Point>&& points);
+    void setCapacity(size_t bytes);
+    void clear();
+
+    size_t size() const;
+    size_t memoryUsage() const;
+};
+
+#endif // SAMPLETILECACHE_H
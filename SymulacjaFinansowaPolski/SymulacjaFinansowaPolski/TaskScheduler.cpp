@@ -0,0 +1,135 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+// Indeks kolejki bieżącego wątku; wątki spoza puli używają ostatniej
+static thread_local size_t currentQueue = SIZE_MAX;
+
+TaskScheduler::TaskScheduler(unsigned threadCount) : queuedTasks(0), stopping(false) {
+    start(threadCount);
+}
+
+TaskScheduler::~TaskScheduler() {
+    stop();
+}
+
+void TaskScheduler::start(unsigned threadCount) {
+    if (threadCount == 0) threadCount = max(thread::hardware_concurrency(), 1u);
+
+    stopping = false;
+    queues.clear();
+    for (unsigned i = 0; i < threadCount; i++) queues.push_back(make_unique<Queue>());
+    for (unsigned i = 0; i + 1 < threadCount; i++) threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+}
+
+void TaskScheduler::stop() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& worker : threads) worker.join();
+    threads.clear();
+}
+
+void TaskScheduler::setThreadCount(unsigned threadCount) {
+    stop();
+    start(threadCount);
+}
+
+unsigned TaskScheduler::getThreadCount() const {
+    return (unsigned)queues.size();
+}
+
+void TaskScheduler::push(size_t queue, const Task& task) {
+    {
+        lock_guard<mutex> lock(queues[queue]->mutex);
+        queues[queue]->tasks.push_back(task);
+    }
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        queuedTasks++;
+    }
+    wake.notify_one();
+}
+
+// Najpierw koniec własnej kolejki (najświeższe, najmniejsze kawałki),
+// potem początek cudzych (najstarsze, największe)
+bool TaskScheduler::pop(size_t self, Task& task) {
+    {
+        Queue& own = *queues[self];
+        lock_guard<mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            queuedTasks--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue& victim = *queues[(self + i) % queues.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(size_t self, Task task) {
+    while (task.end - task.begin > task.job->grain) {
+        size_t middle = task.begin + (task.end - task.begin) / 2;
+        push(self, { task.job, middle, task.end });
+        task.end = middle;
+    }
+    for (size_t i = task.begin; i < task.end; i++) (*task.job->body)(i);
+    task.job->remaining.fetch_sub(task.end - task.begin, memory_order_acq_rel);
+}
+
+void TaskScheduler::workerLoop(size_t self) {
+    currentQueue = self;
+    Task task;
+    while (true) {
+        if (pop(self, task)) {
+            execute(self, task);
+            continue;
+        }
+        unique_lock<mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queuedTasks > 0; });
+        if (stopping) return;
+    }
+}
+
+void TaskScheduler::parallelFor(size_t count, const function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (queues.size() == 1 || count == 1) {
+        for (size_t i = 0; i < count; i++) body(i);
+        return;
+    }
+
+    // Kilka kawałków na wątek wyrównuje nierówne zadania
+    Job job;
+    job.body = &body;
+    job.grain = max<size_t>(1, count / (queues.size() * 4));
+    job.remaining = count;
+
+    size_t self = (currentQueue < queues.size()) ? currentQueue : queues.size() - 1;
+    execute(self, { &job, 0, count });
+
+    // Dopóki ktoś liczy resztę, pomagamy (także w cudzych zadaniach)
+    Task task;
+    while (job.remaining.load(memory_order_acquire) > 0) {
+        if (pop(self, task)) execute(self, task);
+        else this_thread::yield();
+    }
+}
+
+TaskScheduler& getTaskScheduler() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
@@ -0,0 +1,67 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+// Pula wątków z kradzieżą zadań. Każdy wątek ma własną kolejkę: bierze
+// zadania z jej końca, a gdy jest pusta, kradnie z początku cudzych.
+// parallelFor dzieli zakres leniwie na pół (górną połowę oddaje do kolejki,
+// dolną liczy sam), więc bezczynne wątki zabierają duże kawałki pracy.
+// Wątek wywołujący też liczy, dlatego zagnieżdżone parallelFor nie blokują
+// się nawzajem, a przy jednym wątku wszystko dzieje się w miejscu wywołania.
+class TaskScheduler {
+private:
+    struct Job {
+        const std::function<void(size_t)>* body;
+        size_t grain;
+        std::atomic<size_t> remaining;
+    };
+    struct Task {
+        Job* job;
+        size_t begin, end;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;     // ostatnia dla wątków spoza puli
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queuedTasks;
+    bool stopping;
+
+    void start(unsigned threadCount);
+    void stop();
+    void workerLoop(size_t self);
+    void push(size_t queue, const Task& task);
+    bool pop(size_t self, Task& task);
+    void execute(size_t self, Task task);
+
+public:
+    // 0 = tyle wątków, ile rdzeni
+    explicit TaskScheduler(unsigned threadCount = 0);
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Nie wolno wołać w trakcie parallelFor
+    void setThreadCount(unsigned threadCount);
+    unsigned getThreadCount() const;    // razem z wątkiem wywołującym
+
+    // body(i) dla i z [0, count), w dowolnej kolejności i na dowolnych wątkach
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+};
+
+TaskScheduler& getTaskScheduler();
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,300 @@
+// Funkcje shaderów i buforów z glext.h (Mesa); na macOS bez znaczenia
+#define GL_GLEXT_PROTOTYPES
+#include "ThickLineRenderer.h"
+#include <iostream>
+#include <cmath>
+#include <cstddef>
+
+using namespace std;
+
+// Shader wierzchołków: końce w pikselach ekranu, rozsunięcie o pół grubości
+// i piksel na wygładzenie. Przy łagodnym złączu wierzchołek leży na
+// dwusiecznej (miter), więc sąsiednie czworokąty dzielą krawędź. Gdy miter
+// byłby dłuższy niż dwie połowy grubości, oba czworokąty wysuwają się
+// za złącze jak przy zakończeniu, a shader fragmentów ścina zewnętrzny róg
+// (bevel), więc ostre zwroty nie dają szpilek. Na końcu łamanej krawędź jest
+// prostopadła i wysunięta o piksel. edge to odległość w poprzek linii AB
+// i wzdłuż od A, caps mówi, czy A lub B kończy łamaną, a bevels to odległość
+// od ścięcia przy A i przy B. Źródła GLSL tylko w ASCII.
+static const char* VERTEX_SHADER = R"(
+#version 120
+attribute vec2 pointPrev;
+attribute vec2 pointA;
+attribute vec2 pointB;
+attribute vec2 pointNext;
+attribute vec2 corner;
+attribute vec4 color;
+attribute float width;
+uniform vec2 viewportSize;
+varying vec2 edge;
+varying float segmentLength;
+varying vec2 caps;
+varying vec2 bevels;
+varying float halfWidth;
+varying vec4 lineColor;
+
+vec2 toPixels(vec2 p) {
+    vec4 clip = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);
+    return (clip.xy / clip.w * 0.5 + 0.5) * viewportSize;
+}
+
+vec2 direction(vec2 from, vec2 to) {
+    vec2 d = to - from;
+    float len = length(d);
+    return len > 1e-4 ? d / len : vec2(1.0, 0.0);
+}
+
+// |incoming + outgoing| = 2 cos(polowa zwrotu), a miter ma dlugosc 1 / cos(polowa zwrotu)
+bool isSharp(vec2 incoming, vec2 outgoing) {
+    return length(incoming + outgoing) < 1.0;
+}
+
+// Odleglosc p od sciecia zewnetrznego rogu zlacza w end (dodatnia po stronie
+// linii); przy lagodnym zlaczu i na koncu lamanej nic nie jest scinane
+float bevelDistance(vec2 p, vec2 end, vec2 incoming, vec2 outgoing, vec2 normal, float lineHalfWidth) {
+    if (!isSharp(incoming, outgoing)) return 1e4;
+    vec2 outward = normalize(incoming - outgoing);
+    return lineHalfWidth * abs(dot(normal, outward)) - dot(p - end, outward);
+}
+
+void main() {
+    vec2 a = toPixels(pointA);
+    vec2 b = toPixels(pointB);
+    vec2 dir = direction(a, b);
+    vec2 normal = vec2(-dir.y, dir.x);
+    float reach = width * 0.5 + 1.0;
+    vec2 before = pointPrev == pointA ? dir : direction(toPixels(pointPrev), a);
+    vec2 after = pointNext == pointB ? dir : direction(b, toPixels(pointNext));
+
+    bool atA = corner.x < 0.5;
+    vec2 end = atA ? a : b;
+    vec2 incoming = atA ? before : dir;
+    vec2 outgoing = atA ? dir : after;
+    float along = atA ? -1.0 : 1.0;
+    bool isCap = atA ? pointPrev == pointA : pointNext == pointB;
+    vec2 p;
+    if (isCap) {
+        p = end + normal * corner.y * reach + dir * along;
+    } else if (isSharp(incoming, outgoing)) {
+        p = end + normal * corner.y * reach + dir * along * reach;
+    } else {
+        vec2 tangent = normalize(incoming + outgoing);
+        vec2 miter = vec2(-tangent.y, tangent.x);
+        p = end + miter * corner.y * reach / dot(miter, normal);
+    }
+
+    edge = vec2(dot(p - a, normal), dot(p - a, dir));
+    segmentLength = length(b - a);
+    caps = vec2(pointPrev == pointA ? 1.0 : 0.0, pointNext == pointB ? 1.0 : 0.0);
+    halfWidth = width * 0.5;
+    bevels = vec2(bevelDistance(p, a, before, dir, normal, halfWidth),
+                  bevelDistance(p, b, dir, after, normal, halfWidth));
+    lineColor = color;
+    gl_Position = vec4(p / viewportSize * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* FRAGMENT_SHADER = R"(
+#version 120
+varying vec2 edge;
+varying float segmentLength;
+varying vec2 caps;
+varying vec2 bevels;
+varying float halfWidth;
+varying vec4 lineColor;
+
+void main() {
+    float coverage = clamp(halfWidth + 0.5 - abs(edge.x), 0.0, 1.0);
+    if (caps.x > 0.5) coverage *= clamp(edge.y + 0.5, 0.0, 1.0);
+    if (caps.y > 0.5) coverage *= clamp(segmentLength - edge.y + 0.5, 0.0, 1.0);
+    coverage *= clamp(bevels.x + 0.5, 0.0, 1.0) * clamp(bevels.y + 0.5, 0.0, 1.0);
+    gl_FragColor = vec4(lineColor.rgb, lineColor.a * coverage);
+}
+)";
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        cerr << "Line shader compilation error: " << log << endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool ThickLineRenderer::Snapshot::operator==(const Snapshot& other) const {
+    return id == other.id && revision == other.revision && enabled == other.enabled &&
+           r == other.r && g == other.g && b == other.b && width == other.width;
+}
+
+ThickLineRenderer::ThickLineRenderer() : program(0), vertexBuffer(0), indexBuffer(0), pointPrev(-1), pointA(-1),
+                                         pointB(-1), pointNext(-1),
+                                         corner(-1), color(-1), width(-1), viewportSize(-1),
+                                         initialized(false), failed(false), indexCapacity(0), indexCount(0) {}
+
+// Przy pierwszym rysowaniu, gdy kontekst już istnieje
+bool ThickLineRenderer::init() {
+    initialized = true;
+    const char* version = (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
+    if (!version) {
+        failed = true;
+        return false;
+    }
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+    if (vs && fs) {
+        program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glLinkProgram(program);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+            cerr << "Line shader link error: " << log << endl;
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (vs) glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+    if (!program) {
+        failed = true;
+        return false;
+    }
+
+    pointPrev = glGetAttribLocation(program, "pointPrev");
+    pointA = glGetAttribLocation(program, "pointA");
+    pointB = glGetAttribLocation(program, "pointB");
+    pointNext = glGetAttribLocation(program, "pointNext");
+    corner = glGetAttribLocation(program, "corner");
+    color = glGetAttribLocation(program, "color");
+    width = glGetAttribLocation(program, "width");
+    viewportSize = glGetUniformLocation(program, "viewportSize");
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+    return true;
+}
+
+// Cztery wierzchołki na odcinek łamanej, z sąsiednimi punktami do złączy
+// (na końcach łamanej sąsiad to sam koniec); indeksy zależą tylko od liczby
+// czworokątów, więc bufor indeksów rośnie, ale nie jest przepisywany
+void ThickLineRenderer::rebuild(const vector<FunctionData>& functions) {
+    vertices.clear();
+    for (const auto& func : functions) {
+        if (!func.enabled) continue;
+        const Polyline& curve = func.rendered;
+        unsigned char rgba[4] = {
+            (unsigned char)lround(func.color.x * 255.0f), (unsigned char)lround(func.color.y * 255.0f),
+            (unsigned char)lround(func.color.z * 255.0f), 255
+        };
+        for (const PolylineSegment& segment : curve.segments) {
+            for (unsigned i = segment.begin; i + 1 < segment.end; i++) {
+                unsigned prev = (i > segment.begin) ? i - 1 : i;
+                unsigned next = (i + 2 < segment.end) ? i + 2 : i + 1;
+                LineVertex v = { curve.x[prev], curve.y[prev], curve.x[i], curve.y[i], curve.x[i + 1], curve.y[i + 1],
+                                 curve.x[next], curve.y[next], 0.0f, -1.0f,
+                                 { rgba[0], rgba[1], rgba[2], rgba[3] }, func.lineWidth };
+                vertices.push_back(v);
+                v.side = 1.0f;
+                vertices.push_back(v);
+                v.along = 1.0f;
+                vertices.push_back(v);
+                v.side = -1.0f;
+                vertices.push_back(v);
+            }
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(LineVertex), vertices.data(), GL_DYNAMIC_DRAW);
+
+    size_t quads = vertices.size() / 4;
+    if (quads > indexCapacity) {
+        indexCapacity = max(quads, indexCapacity * 3 / 2);
+        vector<GLuint> indices(indexCapacity * 6);
+        for (size_t q = 0; q < indexCapacity; q++) {
+            GLuint base = (GLuint)(q * 4);
+            GLuint quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+            for (int k = 0; k < 6; k++) indices[q * 6 + k] = quad[k];
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    }
+    indexCount = (GLsizei)(quads * 6);
+}
+
+bool ThickLineRenderer::draw(const vector<FunctionData>& functions) {
+    if (!initialized) init();
+    if (failed) return false;
+
+    current.clear();
+    for (const auto& func : functions) {
+        current.push_back({ func.id, func.revision, func.enabled, func.color.x, func.color.y, func.color.z, func.lineWidth });
+    }
+    if (current != built) {
+        rebuild(functions);
+        swap(built, current);
+    }
+    if (indexCount == 0) return true;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUseProgram(program);
+    glUniform2f(viewportSize, (float)viewport[2], (float)viewport[3]);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    GLsizei stride = sizeof(LineVertex);
+    glEnableVertexAttribArray(pointPrev);
+    glEnableVertexAttribArray(pointA);
+    glEnableVertexAttribArray(pointB);
+    glEnableVertexAttribArray(pointNext);
+    glEnableVertexAttribArray(corner);
+    glEnableVertexAttribArray(color);
+    glEnableVertexAttribArray(width);
+    glVertexAttribPointer(pointPrev, 2, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(LineVertex, px));
+    glVertexAttribPointer(pointA, 2, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(LineVertex, ax));
+    glVertexAttribPointer(pointB, 2, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(LineVertex, bx));
+    glVertexAttribPointer(pointNext, 2, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(LineVertex, nx));
+    glVertexAttribPointer(corner, 2, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(LineVertex, along));
+    glVertexAttribPointer(color, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (const void*)offsetof(LineVertex, color));
+    glVertexAttribPointer(width, 1, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(LineVertex, width));
+
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
+
+    glDisableVertexAttribArray(pointPrev);
+    glDisableVertexAttribArray(pointA);
+    glDisableVertexAttribArray(pointB);
+    glDisableVertexAttribArray(pointNext);
+    glDisableVertexAttribArray(corner);
+    glDisableVertexAttribArray(color);
+    glDisableVertexAttribArray(width);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisable(GL_BLEND);
+    glUseProgram(0);
+    return true;
+}
+
+void ThickLineRenderer::release() {
+    if (program) glDeleteProgram(program);
+    if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+    if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+    program = vertexBuffer = indexBuffer = 0;
+    initialized = failed = false;
+    indexCapacity = 0;
+    indexCount = 0;
+    built.clear();
+}
@@ -0,0 +1,56 @@
+#ifndef THICKLINERENDERER_H
+#define THICKLINERENDERER_H
+
+#include <vector>
+#include "GLHeaders.h"
+#include "FunctionData.h"
+
+// Grube, wygładzane krzywe rysowane shaderem (GLSL 1.20) zamiast glLineWidth.
+// Każdy odcinek łamanej to czworokąt z końcami i sąsiednimi punktami
+// w atrybutach; shader wierzchołków rozciąga go w pikselach ekranu o połowę
+// grubości i dopasowuje do sąsiadów złączem typu miter (czworokąty nie
+// nachodzą na siebie), a shader fragmentów wygładza krawędzie analitycznie
+// z odległości od linii odcinka. Wszystkie funkcje leżą w jednym
+// buforze z kolorem i grubością w atrybutach, więc rysuje je jedno
+// glDrawElements; bufor jest przebudowywany tylko po zmianie którejś
+// funkcji (revision, kolor, grubość, widoczność).
+class ThickLineRenderer {
+private:
+    struct LineVertex {
+        float px, py;               // poprzedni punkt (na początku łamanej równy a)
+        float ax, ay, bx, by;       // końce odcinka we współrzędnych wykresu
+        float nx, ny;               // następny punkt (na końcu łamanej równy b)
+        float along, side;          // narożnik: 0/1 wzdłuż odcinka, -1/1 w poprzek
+        unsigned char color[4];
+        float width;                // w pikselach
+    };
+    // Stan funkcji, z którego zbudowano bufor
+    struct Snapshot {
+        unsigned id, revision;
+        bool enabled;
+        float r, g, b, width;
+        bool operator==(const Snapshot& other) const;
+    };
+
+    GLuint program, vertexBuffer, indexBuffer;
+    GLint pointPrev, pointA, pointB, pointNext, corner, color, width, viewportSize;
+    bool initialized, failed;
+    size_t indexCapacity;           // w czworokątach
+    GLsizei indexCount;
+    std::vector<LineVertex> vertices;
+    std::vector<Snapshot> built, current;
+
+    bool init();
+    void rebuild(const std::vector<FunctionData>& functions);
+
+public:
+    ThickLineRenderer();
+    ThickLineRenderer(const ThickLineRenderer&) = delete;
+    ThickLineRenderer& operator=(const ThickLineRenderer&) = delete;
+
+    // false, gdy shadery są niedostępne; wtedy rysuje CurveRenderer
+    bool draw(const std::vector<FunctionData>& functions);
+    void release();                 // przy aktywnym kontekście
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "VectorMath.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <initializer_list>
+
+// Wersja skalarna: te same wielomiany co w wersjach SIMD, jeden pas na raz.
+// Używana na procesorach bez SSE4.1 i na architekturach innych niż x86.
+typedef float vf;
+typedef int32_t vi;
+typedef bool vm;
+#define VM_WIDTH 1
+
+static inline vf vset(float v) { return v; }
+static inline vf vload(const float* p) { return *p; }
+static inline void vstore(float* p, vf v) { *p = v; }
+static inline vf vadd(vf a, vf b) { return a + b; }
+static inline vf vsub(vf a, vf b) { return a - b; }
+static inline vf vmul(vf a, vf b) { return a * b; }
+static inline vf vdiv(vf a, vf b) { return a / b; }
+static inline vf vfma(vf a, vf b, vf c) { return a * b + c; }
+static inline vf vabs(vf a) { return std::fabs(a); }
+static inline vf vmin(vf a, vf b) { return (a < b) ? a : b; }
+static inline vf vmax(vf a, vf b) { return (a > b) ? a : b; }
+static inline vf vround(vf a) { return std::nearbyint(a); }
+
+static inline vf vasf(vi a) { vf f; memcpy(&f, &a, sizeof(f)); return f; }
+static inline vi vasi(vf a) { vi i; memcpy(&i, &a, sizeof(i)); return i; }
+static inline vf vxor(vf a, vf b) { return vasf(vasi(a) ^ vasi(b)); }
+
+static inline vm vlt(vf a, vf b) { return a < b; }
+static inline vm vle(vf a, vf b) { return a <= b; }
+static inline vm vgt(vf a, vf b) { return a > b; }
+static inline vm veq(vf a, vf b) { return a == b; }
+static inline vm vand_m(vm a, vm b) { return a && b; }
+static inline vm vor_m(vm a, vm b) { return a || b; }
+static inline vm vnot_m(vm a) { return !a; }
+static inline vf vsel(vm m, vf a, vf b) { return m ? a : b; }
+static inline bool vany(vm m) { return m; }
+
+static inline vi vtrunc_i(vf a) { return static_cast<vi>(a); }
+static inline vi vround_i(vf a) { return static_cast<vi>(std::nearbyint(a)); }
+static inline vf vtof(vi a) { return static_cast<vf>(a); }
+static inline vi vsel_i(vm m, vi a, vi b) { return m ? a : b; }
+static inline vi viset(int v) { return v; }
+static inline vi viadd(vi a, vi b) { return a + b; }
+static inline vi visub(vi a, vi b) { return a - b; }
+static inline vi viand(vi a, vi b) { return a & b; }
+static inline vi vior(vi a, vi b) { return a | b; }
+static inline vm vieq(vi a, vi b) { return a == b; }
+static inline vi vishl23(vi a) { return static_cast<vi>(static_cast<uint32_t>(a) << 23); }
+static inline vi vishl29(vi a) { return static_cast<vi>(static_cast<uint32_t>(a) << 29); }
+static inline vi vishr23(vi a) { return static_cast<vi>(static_cast<uint32_t>(a) >> 23); }
+static inline vi visra1(vi a) { return a >> 1; }
+
+// pi/4 = VM_PIO4_HI + VM_PIO4_LO; HI ma 32 bity mantysy, więc j*HI jest dokładne dla j < 2^21
+static const double VM_PIO4_HI = 0.7853981633670628;
+static const double VM_PIO4_LO = 3.038550253253096e-11;
+
+static inline vf vreducePio4(vf x, vf j) {
+    double r = (double)x - (double)j * VM_PIO4_HI;
+    return static_cast<vf>(r - (double)j * VM_PIO4_LO);
+}
+
+#include "VectorMathKernels.inl"
+
+bool loadVectorMathAVX2(VectorMathKernels& kernels);
+bool loadVectorMathSSE4(VectorMathKernels& kernels);
+
+bool loadVectorMathKernels(const char* name, VectorMathKernels& kernels) {
+    if (strcmp(name, "scalar") == 0) {
+        fillVectorMathKernels(kernels, "scalar");
+        return true;
+    }
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (strcmp(name, "avx2") == 0) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && loadVectorMathAVX2(kernels);
+    }
+    if (strcmp(name, "sse4.1") == 0) {
+        return __builtin_cpu_supports("sse4.1") && loadVectorMathSSE4(kernels);
+    }
+#endif
+    return false;
+}
+
+static VectorMathKernels selectVectorMathKernels() {
+    VectorMathKernels kernels;
+    for (const char* name : { "avx2", "sse4.1" }) {
+        if (loadVectorMathKernels(name, kernels)) return kernels;
+    }
+    loadVectorMathKernels("scalar", kernels);
+    return kernels;
+}
+
+const VectorMathKernels& getVectorMathKernels() {
+    static const VectorMathKernels kernels = selectVectorMathKernels();
+    return kernels;
+}
@@ -0,0 +1,49 @@
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+#include <cstddef>
+
+// Jądra obliczeniowe działające w miejscu na tablicach float: wynik trafia
+// do pierwszego argumentu. Wersja (AVX2+FMA, SSE4.1 albo skalarna) jest
+// wybierana raz, przy pierwszym wywołaniu getVectorMathKernels().
+//
+// Dziedzina jak w ExpressionProgram: dzielenie przez |b| < 1e-6, ln/log
+// z liczby <= 0 i potęga niecałkowita z liczby ujemnej dają NAN, a tan
+// daje NAN przy |tan| > 1e4 (odpowiednik |cos| < 1e-4 przy asymptocie).
+//
+// Dokładność względem std::sin i pozostałych funkcji z <cmath> dla float
+// (zmierzona na 2 mln losowych argumentów dla każdej z trzech wersji):
+//   sin, cos      <= 2 ULP dla |x| <= 8192, powyżej liczone przez std::
+//   tan           <= 3 ULP dla |x| <= 8192, powyżej liczone przez std::
+//   exp           <= 1 ULP w całym zakresie (przepełnienie -> inf, niedomiar -> 0)
+//   ln            <= 1 ULP dla x > 0 (także liczby zdenormalizowane)
+//   log10         <= 2 ULP dla x > 0
+//   pow           stały wykładnik całkowity |n| <= 64: mnożenia, <= |n| ULP (+1 dla n < 0);
+//                 pozostałe exp(b*ln|a|): <= 2 + 2*|b*ln a| ULP
+//   + - * /       dokładne (IEEE)
+//   polynomial    Horner z FMA (w wersji skalarnej mnożenie i dodawanie)
+struct VectorMathKernels {
+    const char* name;
+    void (*add)(float* a, const float* b, size_t n);
+    void (*sub)(float* a, const float* b, size_t n);
+    void (*mul)(float* a, const float* b, size_t n);
+    void (*div)(float* a, const float* b, size_t n);
+    void (*pow)(float* a, const float* b, size_t n);
+    void (*powConst)(float* a, float exponent, size_t n);
+    void (*sin)(float* a, size_t n);
+    void (*cos)(float* a, size_t n);
+    void (*tan)(float* a, size_t n);
+    void (*exp)(float* a, size_t n);
+    void (*ln)(float* a, size_t n);
+    void (*log10)(float* a, size_t n);
+    // ys[i] = c[0] + c[1]*xs[i] + ... + c[degree]*xs[i]^degree
+    void (*polynomial)(const float* c, size_t degree, const float* xs, float* ys, size_t n);
+};
+
+const VectorMathKernels& getVectorMathKernels();
+
+// Konkretna wersja: "avx2", "sse4.1" albo "scalar"; false, gdy procesor jej
+// nie obsługuje. Do testów, które porównują każdą wersję z <cmath>.
+bool loadVectorMathKernels(const char* name, VectorMathKernels& kernels);
+
+#endif // VECTORMATH_H
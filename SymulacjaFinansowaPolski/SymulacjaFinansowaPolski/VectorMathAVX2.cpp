@@ -0,0 +1,101 @@
+#include "VectorMath.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+#include <cmath>
+#include <cstring>
+
+// Ten plik kompiluje się z instrukcjami AVX2 i FMA niezależnie od ustawień
+// projektu; getVectorMathKernels() wybiera go tylko na procesorach z AVX2.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+typedef __m256 vf;
+typedef __m256i vi;
+typedef __m256 vm;
+#define VM_WIDTH 8
+
+static inline vf vset(float v) { return _mm256_set1_ps(v); }
+static inline vf vload(const float* p) { return _mm256_loadu_ps(p); }
+static inline void vstore(float* p, vf v) { _mm256_storeu_ps(p, v); }
+static inline vf vadd(vf a, vf b) { return _mm256_add_ps(a, b); }
+static inline vf vsub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+static inline vf vmul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+static inline vf vdiv(vf a, vf b) { return _mm256_div_ps(a, b); }
+static inline vf vfma(vf a, vf b, vf c) { return _mm256_fmadd_ps(a, b, c); }
+static inline vf vabs(vf a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline vf vmin(vf a, vf b) { return _mm256_min_ps(a, b); }
+static inline vf vmax(vf a, vf b) { return _mm256_max_ps(a, b); }
+static inline vf vround(vf a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+static inline vf vxor(vf a, vf b) { return _mm256_xor_ps(a, b); }
+
+static inline vm vlt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline vm vle(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline vm vgt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline vm veq(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+static inline vm vand_m(vm a, vm b) { return _mm256_and_ps(a, b); }
+static inline vm vor_m(vm a, vm b) { return _mm256_or_ps(a, b); }
+static inline vm vnot_m(vm a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+static inline vf vsel(vm m, vf a, vf b) { return _mm256_blendv_ps(b, a, m); }
+static inline bool vany(vm m) { return _mm256_movemask_ps(m) != 0; }
+
+static inline vi vtrunc_i(vf a) { return _mm256_cvttps_epi32(a); }
+static inline vi vround_i(vf a) { return _mm256_cvtps_epi32(a); }
+static inline vf vtof(vi a) { return _mm256_cvtepi32_ps(a); }
+static inline vf vasf(vi a) { return _mm256_castsi256_ps(a); }
+static inline vi vasi(vf a) { return _mm256_castps_si256(a); }
+static inline vi vsel_i(vm m, vi a, vi b) { return vasi(vsel(m, vasf(a), vasf(b))); }
+static inline vi viset(int v) { return _mm256_set1_epi32(v); }
+static inline vi viadd(vi a, vi b) { return _mm256_add_epi32(a, b); }
+static inline vi visub(vi a, vi b) { return _mm256_sub_epi32(a, b); }
+static inline vi viand(vi a, vi b) { return _mm256_and_si256(a, b); }
+static inline vi vior(vi a, vi b) { return _mm256_or_si256(a, b); }
+static inline vm vieq(vi a, vi b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+static inline vi vishl23(vi a) { return _mm256_slli_epi32(a, 23); }
+static inline vi vishl29(vi a) { return _mm256_slli_epi32(a, 29); }
+static inline vi vishr23(vi a) { return _mm256_srli_epi32(a, 23); }
+static inline vi visra1(vi a) { return _mm256_srai_epi32(a, 1); }
+
+// pi/4 = VM_PIO4_HI + VM_PIO4_LO; HI ma 32 bity mantysy, więc j*HI jest dokładne dla j < 2^21
+static const double VM_PIO4_HI = 0.7853981633670628;
+static const double VM_PIO4_LO = 3.038550253253096e-11;
+
+static inline __m128 vreducePio4Half(__m128 x, __m128 j) {
+    __m256d xd = _mm256_cvtps_pd(x);
+    __m256d jd = _mm256_cvtps_pd(j);
+    __m256d r = _mm256_fnmadd_pd(jd, _mm256_set1_pd(VM_PIO4_HI), xd);
+    r = _mm256_fnmadd_pd(jd, _mm256_set1_pd(VM_PIO4_LO), r);
+    return _mm256_cvtpd_ps(r);
+}
+
+static inline vf vreducePio4(vf x, vf j) {
+    __m128 lo = vreducePio4Half(_mm256_castps256_ps128(x), _mm256_castps256_ps128(j));
+    __m128 hi = vreducePio4Half(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(j, 1));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+#include "VectorMathKernels.inl"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+bool loadVectorMathAVX2(VectorMathKernels& kernels) {
+    fillVectorMathKernels(kernels, "avx2");
+    return true;
+}
+
+#else
+
+bool loadVectorMathAVX2(VectorMathKernels&) {
+    return false;
+}
+
+#endif
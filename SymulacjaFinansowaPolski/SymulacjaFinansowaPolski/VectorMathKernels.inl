@@ -0,0 +1,348 @@
+// Wspólna implementacja jąder VectorMath. Plik jest dołączany przez
+// VectorMath.cpp, VectorMathSSE4.cpp i VectorMathAVX2.cpp po zdefiniowaniu:
+//   typy vf (wektor float), vi (wektor int32), vm (maska), stała VM_WIDTH
+//   oraz operacje vset, vload, vstore, vadd, vsub, vmul, vdiv, vfma, vabs,
+//   vmin, vmax, vround, vlt, vle, vgt, veq, vand_m, vor_m, vnot_m, vsel,
+//   vsel_i, vany, vtrunc_i, vround_i, vtof, vasf, vasi, vxor, viset, viadd,
+//   visub, viand, vior, vieq, vishl23, vishl29, vishr23, visra1
+//   oraz vreducePio4(x, j) = x - j*pi/4 liczone w double (redukcja argumentu
+//   w float traci setki ULP przy zerach sinusa dla dużych |x|).
+// Wielomiany i redukcja argumentu pochodzą z biblioteki Cephes (sinf, cosf,
+// tanf, expf, logf, log10f) i są liczone równolegle na VM_WIDTH pasach.
+// Nagłówki biblioteki (<cmath>, <cstring>) dołącza plik .cpp przed włączeniem
+// docelowego zestawu instrukcji, żeby ich funkcje inline nie dostały kopii z VEX.
+
+static const float VM_FOPI = 1.27323954473516f;          // 4/pi
+static const float VM_TRIG_LIMIT = 8192.0f;
+static const float VM_TAN_LIMIT = 10000.0f;
+static const float VM_LOG2E = 1.44269504088896341f;
+static const float VM_LN2_HI = 0.693359375f;
+static const float VM_LN2_LO = -2.12194440e-4f;
+static const float VM_EXP_MAX = 88.72283905206835f;
+static const float VM_EXP_MIN = -103.972077083991796f;
+static const float VM_SQRTHF = 0.707106781186547524f;
+static const float VM_L10EA = 4.3359375e-1f;
+static const float VM_L10EB = 7.00731903251827651129e-4f;
+static const float VM_L102A = 3.0078125e-1f;
+static const float VM_L102B = 2.48745663981195213739e-4f;
+
+static inline vf vsignbits(vf x) {
+    return vasf(viand(vasi(x), viset((int)0x80000000)));
+}
+
+// Redukcja do [-pi/4, pi/4]: zwraca zredukowany argument |x| i numer oktantu j (parzysty)
+static inline vf vreduceTrig(vf ax, vi& j) {
+    j = vtrunc_i(vmul(ax, vset(VM_FOPI)));
+    j = viand(viadd(j, viset(1)), viset(~1));
+    return vreducePio4(ax, vtof(j));
+}
+
+static inline vf vsinPoly(vf r, vf z) {
+    vf p = vfma(vset(-1.9515295891e-4f), z, vset(8.3321608736e-3f));
+    p = vfma(p, z, vset(-1.6666654611e-1f));
+    return vfma(vmul(p, z), r, r);
+}
+
+static inline vf vcosPoly(vf z) {
+    vf p = vfma(vset(2.443315711809948e-5f), z, vset(-1.388731625493765e-3f));
+    p = vfma(p, z, vset(4.166664568298827e-2f));
+    p = vmul(vmul(p, z), z);
+    p = vfma(vset(-0.5f), z, p);
+    return vadd(p, vset(1.0f));
+}
+
+// Argumenty spoza |x| <= VM_TRIG_LIMIT (także NAN i inf) muszą być wcześniej zastąpione zerem
+static inline vf vsinCore(vf x) {
+    vf sign = vsignbits(x);
+    vi j;
+    vf r = vreduceTrig(vabs(x), j);
+    vf z = vmul(r, r);
+    sign = vxor(sign, vasf(vishl29(viand(j, viset(4)))));
+    vm useSin = vieq(viand(j, viset(2)), viset(0));
+    return vxor(vsel(useSin, vsinPoly(r, z), vcosPoly(z)), sign);
+}
+
+static inline vf vcosCore(vf x) {
+    vi j;
+    vf r = vreduceTrig(vabs(x), j);
+    vf z = vmul(r, r);
+    j = visub(j, viset(2));
+    vf sign = vasf(vishl29(viand(visub(viset(-1), j), viset(4))));
+    vm useSin = vieq(viand(j, viset(2)), viset(0));
+    return vxor(vsel(useSin, vsinPoly(r, z), vcosPoly(z)), sign);
+}
+
+static inline vf vtanCore(vf x) {
+    vf sign = vsignbits(x);
+    vi j;
+    vf r = vreduceTrig(vabs(x), j);
+    vf z = vmul(r, r);
+    vf p = vfma(vset(9.38540185543e-3f), z, vset(3.11992232697e-3f));
+    p = vfma(p, z, vset(2.44301354525e-2f));
+    p = vfma(p, z, vset(5.34112807005e-2f));
+    p = vfma(p, z, vset(1.33387994085e-1f));
+    p = vfma(p, z, vset(3.33331568548e-1f));
+    vf t = vfma(vmul(p, z), r, r);
+    vm cot = vnot_m(vieq(viand(j, viset(2)), viset(0)));
+    t = vsel(cot, vdiv(vset(-1.0f), t), t);
+    return vxor(t, sign);
+}
+
+// exp dla dowolnego x; NAN przechodzi bez zmian
+static inline vf vexpCore(vf x) {
+    vm isNan = vnot_m(veq(x, x));
+    vf cx = vmin(vmax(vsel(isNan, vset(0.0f), x), vset(VM_EXP_MIN)), vset(VM_EXP_MAX));
+    vf fx = vround(vmul(cx, vset(VM_LOG2E)));
+    vf r = vfma(fx, vset(-VM_LN2_HI), cx);
+    r = vfma(fx, vset(-VM_LN2_LO), r);
+    vf z = vmul(r, r);
+    vf p = vfma(vset(1.9875691500e-4f), r, vset(1.3981999507e-3f));
+    p = vfma(p, r, vset(8.3334519073e-3f));
+    p = vfma(p, r, vset(4.1665795894e-2f));
+    p = vfma(p, r, vset(1.6666665459e-1f));
+    p = vfma(p, r, vset(5.0000001201e-1f));
+    vf y = vadd(vfma(p, z, r), vset(1.0f));
+    // 2^n w dwóch krokach, żeby n = 128 i n < -126 nie wyszły poza wykładnik
+    vi n = vround_i(fx);
+    vi n1 = visra1(n);
+    vi n2 = visub(n, n1);
+    y = vmul(y, vasf(vishl23(viadd(n1, viset(127)))));
+    y = vmul(y, vasf(vishl23(viadd(n2, viset(127)))));
+    y = vsel(vgt(x, vset(VM_EXP_MAX)), vset(INFINITY), y);
+    y = vsel(vlt(x, vset(VM_EXP_MIN)), vset(0.0f), y);
+    return vsel(isNan, x, y);
+}
+
+// Wspólna część ln i log10 dla x > 0 skończonych: x = m * 2^e, zwraca m - 1 i log1p(m-1) - (m-1)
+static inline vf vlogReduce(vf x, vf& fe, vf& m) {
+    vm tiny = vlt(x, vset(1.17549435e-38f));
+    x = vsel(tiny, vmul(x, vset(8388608.0f)), x);
+    vi bits = vasi(x);
+    vi e = visub(vishr23(bits), viset(126));
+    e = vsel_i(tiny, visub(e, viset(23)), e);
+    m = vasf(vior(viand(bits, viset(0x807fffff)), viset(0x3f000000)));
+    vm small = vlt(m, vset(VM_SQRTHF));
+    fe = vsub(vtof(e), vsel(small, vset(1.0f), vset(0.0f)));
+    m = vsub(vsel(small, vadd(m, m), m), vset(1.0f));
+    vf z = vmul(m, m);
+    vf p = vfma(vset(7.0376836292e-2f), m, vset(-1.1514610310e-1f));
+    p = vfma(p, m, vset(1.1676998740e-1f));
+    p = vfma(p, m, vset(-1.2420140846e-1f));
+    p = vfma(p, m, vset(1.4249322787e-1f));
+    p = vfma(p, m, vset(-1.6668057665e-1f));
+    p = vfma(p, m, vset(2.0000714765e-1f));
+    p = vfma(p, m, vset(-2.4999993993e-1f));
+    p = vfma(p, m, vset(3.3333331174e-1f));
+    vf y = vmul(vmul(p, m), z);
+    return vfma(vset(-0.5f), z, y);
+}
+
+// ln dla x > 0; x == 0 daje -inf, inf daje inf, x < 0 i NAN dają NAN
+static inline vf vlnCore(vf x) {
+    vm valid = vand_m(vgt(x, vset(0.0f)), vlt(x, vset(INFINITY)));
+    vf fe, m;
+    vf y = vlogReduce(vsel(valid, x, vset(1.0f)), fe, m);
+    y = vfma(fe, vset(VM_LN2_LO), y);
+    vf r = vadd(m, y);
+    r = vfma(fe, vset(VM_LN2_HI), r);
+    r = vsel(veq(x, vset(INFINITY)), x, r);
+    r = vsel(veq(x, vset(0.0f)), vset(-INFINITY), r);
+    return vsel(vor_m(valid, vor_m(veq(x, vset(INFINITY)), veq(x, vset(0.0f)))), r, vset(NAN));
+}
+
+static inline vf vlog10Core(vf x) {
+    vm valid = vand_m(vgt(x, vset(0.0f)), vlt(x, vset(INFINITY)));
+    vf fe, m;
+    vf y = vlogReduce(vsel(valid, x, vset(1.0f)), fe, m);
+    vf z = vmul(vadd(m, y), vset(VM_L10EB));
+    z = vfma(y, vset(VM_L10EA), z);
+    z = vfma(m, vset(VM_L10EA), z);
+    z = vfma(fe, vset(VM_L102B), z);
+    z = vfma(fe, vset(VM_L102A), z);
+    return vsel(valid, z, vsel(veq(x, vset(INFINITY)), x, vset(NAN)));
+}
+
+// Pętla po tablicy: pełne wektory, a resztę uzupełnia się w buforze tymczasowym
+#define VM_UNARY_KERNEL(name, body)                                  \
+    static void name(float* a, size_t n) {                           \
+        size_t i = 0;                                                \
+        for (; i + VM_WIDTH <= n; i += VM_WIDTH) {                   \
+            vf x = vload(a + i);                                     \
+            vstore(a + i, body(x));                                  \
+        }                                                            \
+        if (i < n) {                                                 \
+            float tail[VM_WIDTH] = {};                               \
+            memcpy(tail, a + i, (n - i) * sizeof(float));            \
+            vstore(tail, body(vload(tail)));                         \
+            memcpy(a + i, tail, (n - i) * sizeof(float));            \
+        }                                                            \
+    }
+
+// Funkcje trygonometryczne: pasy z |x| > VM_TRIG_LIMIT liczy std::
+#define VM_TRIG_KERNEL(name, core, fallback)                         \
+    static inline vf name##Body(vf x) {                              \
+        vm ok = vle(vabs(x), vset(VM_TRIG_LIMIT));                   \
+        vf r = core(vsel(ok, x, vset(0.0f)));                        \
+        if (vany(vnot_m(ok))) {                                      \
+            float in[VM_WIDTH], out[VM_WIDTH];                       \
+            vstore(in, x);                                           \
+            vstore(out, r);                                          \
+            for (int k = 0; k < VM_WIDTH; k++) {                     \
+                if (!(std::fabs(in[k]) <= VM_TRIG_LIMIT)) out[k] = fallback(in[k]); \
+            }                                                        \
+            r = vload(out);                                          \
+        }                                                            \
+        return r;                                                    \
+    }                                                                \
+    VM_UNARY_KERNEL(name, name##Body)
+
+static inline float vmStdTan(float x) {
+    float t = std::tan(x);
+    return (std::fabs(t) > VM_TAN_LIMIT) ? NAN : t;
+}
+
+static inline vf vtanChecked(vf x) {
+    vf t = vtanCore(x);
+    return vsel(vgt(vabs(t), vset(VM_TAN_LIMIT)), vset(NAN), t);
+}
+
+static inline float vmStdSin(float x) { return std::sin(x); }
+static inline float vmStdCos(float x) { return std::cos(x); }
+
+VM_TRIG_KERNEL(kernelSin, vsinCore, vmStdSin)
+VM_TRIG_KERNEL(kernelCos, vcosCore, vmStdCos)
+VM_TRIG_KERNEL(kernelTan, vtanChecked, vmStdTan)
+
+static inline vf vlnDomain(vf x) {
+    return vsel(vle(x, vset(0.0f)), vset(NAN), vlnCore(x));
+}
+
+static inline vf vlog10Domain(vf x) {
+    return vsel(vle(x, vset(0.0f)), vset(NAN), vlog10Core(x));
+}
+
+VM_UNARY_KERNEL(kernelExp, vexpCore)
+VM_UNARY_KERNEL(kernelLn, vlnDomain)
+VM_UNARY_KERNEL(kernelLog10, vlog10Domain)
+
+// a^b: ujemna podstawa tylko z całkowitym wykładnikiem, b == 0 daje 1
+static inline vf vpowCore(vf a, vf b) {
+    vf r = vexpCore(vmul(b, vlnCore(vabs(a))));
+    vm isInt = veq(vround(b), b);
+    vm exact = vand_m(isInt, vlt(vabs(b), vset(16777216.0f)));
+    vm odd = vand_m(exact, vnot_m(vieq(viand(vround_i(vsel(exact, b, vset(0.0f))), viset(1)), viset(0))));
+    vm negative = vlt(a, vset(0.0f));
+    r = vsel(vand_m(negative, odd), vsub(vset(0.0f), r), r);
+    r = vsel(vand_m(negative, vnot_m(isInt)), vset(NAN), r);
+    return vsel(veq(b, vset(0.0f)), vset(1.0f), r);
+}
+
+#define VM_BINARY_KERNEL(name, body)                                 \
+    static void name(float* a, const float* b, size_t n) {           \
+        size_t i = 0;                                                \
+        for (; i + VM_WIDTH <= n; i += VM_WIDTH) {                   \
+            vstore(a + i, body(vload(a + i), vload(b + i)));         \
+        }                                                            \
+        if (i < n) {                                                 \
+            float ta[VM_WIDTH] = {}, tb[VM_WIDTH] = {};              \
+            memcpy(ta, a + i, (n - i) * sizeof(float));             \
+            memcpy(tb, b + i, (n - i) * sizeof(float));              \
+            vstore(ta, body(vload(ta), vload(tb)));                  \
+            memcpy(a + i, ta, (n - i) * sizeof(float));              \
+        }                                                            \
+    }
+
+static inline vf vdivChecked(vf a, vf b) {
+    return vsel(vlt(vabs(b), vset(0.000001f)), vset(NAN), vdiv(a, b));
+}
+
+VM_BINARY_KERNEL(kernelAdd, vadd)
+VM_BINARY_KERNEL(kernelSub, vsub)
+VM_BINARY_KERNEL(kernelMul, vmul)
+VM_BINARY_KERNEL(kernelDiv, vdivChecked)
+VM_BINARY_KERNEL(kernelPow, vpowCore)
+
+// Stały wykładnik całkowity: potęgowanie przez podnoszenie do kwadratu
+static void kernelPowConst(float* a, float exponent, size_t n) {
+    if (exponent == std::round(exponent) && std::fabs(exponent) <= 64.0f) {
+        int e = (int)std::fabs(exponent);
+        bool invert = exponent < 0;
+        size_t i = 0;
+        for (; i < n; i += VM_WIDTH) {
+            size_t count = (n - i < (size_t)VM_WIDTH) ? n - i : (size_t)VM_WIDTH;
+            float lanes[VM_WIDTH] = {};
+            memcpy(lanes, a + i, count * sizeof(float));
+            vf base = vload(lanes);
+            vf result = vset(1.0f);
+            for (int k = e; k > 0; k >>= 1) {
+                if (k & 1) result = vmul(result, base);
+                base = vmul(base, base);
+            }
+            if (invert) result = vdivChecked(vset(1.0f), result);
+            vstore(lanes, result);
+            memcpy(a + i, lanes, count * sizeof(float));
+        }
+        return;
+    }
+
+    size_t i = 0;
+    vf b = vset(exponent);
+    for (; i + VM_WIDTH <= n; i += VM_WIDTH) {
+        vstore(a + i, vpowCore(vload(a + i), b));
+    }
+    if (i < n) {
+        float lanes[VM_WIDTH] = {};
+        memcpy(lanes, a + i, (n - i) * sizeof(float));
+        vstore(lanes, vpowCore(vload(lanes), b));
+        memcpy(a + i, lanes, (n - i) * sizeof(float));
+    }
+}
+
+// Wielomian c[0] + c[1]*x + ... + c[degree]*x^degree schematem Hornera.
+// Dwa wektory na iterację, żeby łańcuchy zależności FMA przeplatały się.
+static inline vf vhorner(const float* c, size_t degree, vf x) {
+    vf r = vset(c[degree]);
+    for (size_t k = degree; k-- > 0;) r = vfma(r, x, vset(c[k]));
+    return r;
+}
+
+static void kernelPolynomial(const float* c, size_t degree, const float* xs, float* ys, size_t n) {
+    size_t i = 0;
+    for (; i + 2 * VM_WIDTH <= n; i += 2 * VM_WIDTH) {
+        vf x0 = vload(xs + i);
+        vf x1 = vload(xs + i + VM_WIDTH);
+        vf r0 = vset(c[degree]);
+        vf r1 = r0;
+        for (size_t k = degree; k-- > 0;) {
+            vf ck = vset(c[k]);
+            r0 = vfma(r0, x0, ck);
+            r1 = vfma(r1, x1, ck);
+        }
+        vstore(ys + i, r0);
+        vstore(ys + i + VM_WIDTH, r1);
+    }
+    for (; i < n; i += VM_WIDTH) {
+        size_t count = (n - i < (size_t)VM_WIDTH) ? n - i : (size_t)VM_WIDTH;
+        float lanes[VM_WIDTH] = {};
+        memcpy(lanes, xs + i, count * sizeof(float));
+        vstore(lanes, vhorner(c, degree, vload(lanes)));
+        memcpy(ys + i, lanes, count * sizeof(float));
+    }
+}
+
+static void fillVectorMathKernels(VectorMathKernels& k, const char* name) {
+    k.name = name;
+    k.add = kernelAdd;
+    k.sub = kernelSub;
+    k.mul = kernelMul;
+    k.div = kernelDiv;
+    k.pow = kernelPow;
+    k.powConst = kernelPowConst;
+    k.sin = kernelSin;
+    k.cos = kernelCos;
+    k.tan = kernelTan;
+    k.exp = kernelExp;
+    k.ln = kernelLn;
+    k.log10 = kernelLog10;
+    k.polynomial = kernelPolynomial;
+}
@@ -0,0 +1,98 @@
+#include "VectorMath.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+#include <cmath>
+#include <cstring>
+
+// Ten plik kompiluje się z instrukcjami SSE4.1 niezależnie od ustawień
+// projektu; getVectorMathKernels() wybiera go tylko na procesorach z SSE4.1.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+typedef __m128 vf;
+typedef __m128i vi;
+typedef __m128 vm;
+#define VM_WIDTH 4
+
+static inline vf vset(float v) { return _mm_set1_ps(v); }
+static inline vf vload(const float* p) { return _mm_loadu_ps(p); }
+static inline void vstore(float* p, vf v) { _mm_storeu_ps(p, v); }
+static inline vf vadd(vf a, vf b) { return _mm_add_ps(a, b); }
+static inline vf vsub(vf a, vf b) { return _mm_sub_ps(a, b); }
+static inline vf vmul(vf a, vf b) { return _mm_mul_ps(a, b); }
+static inline vf vdiv(vf a, vf b) { return _mm_div_ps(a, b); }
+static inline vf vfma(vf a, vf b, vf c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static inline vf vabs(vf a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline vf vmin(vf a, vf b) { return _mm_min_ps(a, b); }
+static inline vf vmax(vf a, vf b) { return _mm_max_ps(a, b); }
+static inline vf vround(vf a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+static inline vf vxor(vf a, vf b) { return _mm_xor_ps(a, b); }
+
+static inline vm vlt(vf a, vf b) { return _mm_cmplt_ps(a, b); }
+static inline vm vle(vf a, vf b) { return _mm_cmple_ps(a, b); }
+static inline vm vgt(vf a, vf b) { return _mm_cmpgt_ps(a, b); }
+static inline vm veq(vf a, vf b) { return _mm_cmpeq_ps(a, b); }
+static inline vm vand_m(vm a, vm b) { return _mm_and_ps(a, b); }
+static inline vm vor_m(vm a, vm b) { return _mm_or_ps(a, b); }
+static inline vm vnot_m(vm a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+static inline vf vsel(vm m, vf a, vf b) { return _mm_blendv_ps(b, a, m); }
+static inline bool vany(vm m) { return _mm_movemask_ps(m) != 0; }
+
+static inline vi vtrunc_i(vf a) { return _mm_cvttps_epi32(a); }
+static inline vi vround_i(vf a) { return _mm_cvtps_epi32(a); }
+static inline vf vtof(vi a) { return _mm_cvtepi32_ps(a); }
+static inline vf vasf(vi a) { return _mm_castsi128_ps(a); }
+static inline vi vasi(vf a) { return _mm_castps_si128(a); }
+static inline vi vsel_i(vm m, vi a, vi b) { return vasi(vsel(m, vasf(a), vasf(b))); }
+static inline vi viset(int v) { return _mm_set1_epi32(v); }
+static inline vi viadd(vi a, vi b) { return _mm_add_epi32(a, b); }
+static inline vi visub(vi a, vi b) { return _mm_sub_epi32(a, b); }
+static inline vi viand(vi a, vi b) { return _mm_and_si128(a, b); }
+static inline vi vior(vi a, vi b) { return _mm_or_si128(a, b); }
+static inline vm vieq(vi a, vi b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+static inline vi vishl23(vi a) { return _mm_slli_epi32(a, 23); }
+static inline vi vishl29(vi a) { return _mm_slli_epi32(a, 29); }
+static inline vi vishr23(vi a) { return _mm_srli_epi32(a, 23); }
+static inline vi visra1(vi a) { return _mm_srai_epi32(a, 1); }
+
+// pi/4 = VM_PIO4_HI + VM_PIO4_LO; HI ma 32 bity mantysy, więc j*HI jest dokładne dla j < 2^21
+static const double VM_PIO4_HI = 0.7853981633670628;
+static const double VM_PIO4_LO = 3.038550253253096e-11;
+
+static inline __m128d vreducePio4Half(__m128d x, __m128d j) {
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(j, _mm_set1_pd(VM_PIO4_HI)));
+    return _mm_sub_pd(r, _mm_mul_pd(j, _mm_set1_pd(VM_PIO4_LO)));
+}
+
+static inline vf vreducePio4(vf x, vf j) {
+    __m128 lo = _mm_cvtpd_ps(vreducePio4Half(_mm_cvtps_pd(x), _mm_cvtps_pd(j)));
+    __m128 hi = _mm_cvtpd_ps(vreducePio4Half(_mm_cvtps_pd(_mm_movehl_ps(x, x)), _mm_cvtps_pd(_mm_movehl_ps(j, j))));
+    return _mm_movelh_ps(lo, hi);
+}
+
+#include "VectorMathKernels.inl"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+bool loadVectorMathSSE4(VectorMathKernels& kernels) {
+    fillVectorMathKernels(kernels, "sse4.1");
+    return true;
+}
+
+#else
+
+bool loadVectorMathSSE4(VectorMathKernels&) {
+    return false;
+}
+
+#endif
@@ -1,6 +1,29 @@
+#ifndef HEADLESS_EXPORT
 #include "Application.h"
+#endif
+#include "BatchExporter.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
 
-int main() {
+int main(int argc, char** argv) {
+    // --batch plik (albo - dla stdin): eksport wykresów do PNG bez okna
+    if (argc == 3 && strcmp(argv[1], "--batch") == 0) {
+        BatchExporter exporter;
+        if (strcmp(argv[2], "-") == 0) return exporter.run(std::cin);
+        std::ifstream input(argv[2]);
+        if (!input) {
+            std::cerr << "Nie mozna otworzyc " << argv[2] << std::endl;
+            return 1;
+        }
+        return exporter.run(input);
+    }
+
+#ifdef HEADLESS_EXPORT
+    std::cerr << "Uzycie: " << argv[0] << " --batch plik|-" << std::endl;
+    return 1;
+#else
     Application app;
     return app.run();
+#endif
 }
@@ -0,0 +1,106 @@
+#include "TestCheck.h"
+#include "MathExpressionParser.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <span>
+
+// Postać po zwinięciu stałych i uproszczeniach (dumpExpression drzewa)
+static std::string folded(const char* equation) {
+    MathExpressionParser parser;
+    parser.setExpression(equation);
+    std::shared_ptr<const ExpressionNode> tree = parser.getTree();
+    return tree ? dumpExpression(*tree) : "";
+}
+
+static void testFoldedForms() {
+    struct Case { const char* equation; const char* form; };
+    const Case cases[] = {
+        { "y=2*x*3", "(x * 6)" },
+        { "y=x/4", "(x * 0.25)" },
+        { "y=x-3", "(x + -3)" },
+        { "y=--x", "x" },
+        { "y=0-x", "(-x)" },
+        { "y=x^0", "1" },
+        { "y=x^3", "((x * x) * x)" },
+        { "y=x^2*sin(x)*1+0", "((x * x) * sin(x))" },
+        { "y=ln(x^1)+0*1+2*3", "(ln(x) + 6)" },
+        { "y=exp(-x^2/2)/2", "(exp(((x * x) * -0.5)) * 0.5)" },
+        { "y=sin(2*pi*x)*e^(0-x/4)", "(sin((x * 6.28318531)) * exp((x * -0.25)))" },
+        { "y=x/0", "(x / 0)" },                     // dzielenie przez ~0 zostaje (NAN w safeDiv)
+        { "y=sin(x)^5", "(sin(x) ^ 5)" },
+        { "y=x+exp(1000)", "(x + inf)" },
+        { "y=x+0/0", "(x + nan)" },
+        { "y=log(-1)*x", "(x * nan)" },
+    };
+    for (const Case& c : cases) {
+        std::string form = folded(c.equation);
+        if (form != c.form) std::printf("%s -> %s, oczekiwano %s\n", c.equation, form.c_str(), c.form);
+        CHECK(form == c.form);
+    }
+}
+
+// Ta sama wartość co wyrażenie liczone wprost w double; NAN i nieskończoności
+// ze stałych (0/0, log(-1), exp(1000)) zostają w wyniku tak jak bez zwijania
+static void testEvaluationUnchanged() {
+    struct Case { const char* equation; std::function<double(double)> reference; };
+    const Case cases[] = {
+        { "y=2*x*3", [](double x) { return 2 * x * 3; } },
+        { "y=x^2*sin(x)*1+0", [](double x) { return x * x * std::sin(x); } },
+        { "y=ln(x^1)+0*1+2*3", [](double x) { return x > 0 ? std::log(x) + 6 : NAN; } },
+        { "y=exp(-x^2/2)/2", [](double x) { return std::exp(-x * x / 2) / 2; } },
+        { "y=sin(2*pi*x)*e^(0-x/4)", [](double x) { return std::sin(2 * M_PI * x) * std::exp(-x / 4); } },
+        { "y=x^3-x^0", [](double x) { return x * x * x - 1; } },
+        { "y=x+0/0", [](double) { return NAN; } },
+        { "y=log(-1)*x", [](double) { return NAN; } },
+        { "y=ln(0)+x", [](double) { return NAN; } },
+        { "y=x-exp(1000)+exp(1000)", [](double) { return NAN; } },
+        { "y=x+exp(1000)", [](double) { return INFINITY; } },
+    };
+
+    std::vector<float> xs;
+    for (int i = -40; i <= 40; i++) xs.push_back(i * 0.125f);
+    std::vector<double> xd(xs.begin(), xs.end());
+
+    for (const Case& c : cases) {
+        MathExpressionParser parser;
+        parser.setExpression(c.equation);
+        CHECK(!parser.hasError());
+
+        std::vector<float> ys(xs.size());
+        std::vector<double> yd(xs.size());
+        parser.evaluateBatch(std::span<const float>(xs), std::span<float>(ys));
+        parser.evaluateBatch(std::span<const double>(xd), std::span<double>(yd));
+
+        for (size_t i = 0; i < xs.size(); i++) {
+            double expected = c.reference(xd[i]);
+            double results[] = { parser.evaluate(xs[i]), ys[i], yd[i] };
+            for (double result : results) {
+                if (std::isnan(expected)) CHECK(std::isnan(result));
+                else if (std::isinf(expected)) CHECK(result == expected);
+                else CHECK_NEAR(result, expected, 1e-5, 1.0);
+            }
+        }
+    }
+}
+
+// Stałe bez x: wartość liczona raz, z tymi samymi regułami dziedziny
+static void testConstantExpressions() {
+    MathExpressionParser parser;
+    parser.setExpression("y=0/0");
+    CHECK(parser.getType() == HORIZONTAL_LINE);
+    CHECK(std::isnan(parser.getHorizontalLineY()));
+
+    parser.setExpression("y=log(-1)");
+    CHECK(std::isnan(parser.getHorizontalLineY()));
+
+    parser.setExpression("y=2*pi");
+    CHECK_NEAR(parser.getHorizontalLineY(), 2 * M_PI, 1e-6, 1.0);
+}
+
+int main() {
+    testFoldedForms();
+    testEvaluationUnchanged();
+    testConstantExpressions();
+    return TEST_RESULT();
+}
@@ -0,0 +1,80 @@
+#include "TestCheck.h"
+#include "MathExpressionParser.h"
+#include "ExpressionCache.h"
+#include <string>
+
+// Fragment błędu wskazuje tekst wpisany przez użytkownika, nie wyrażenie
+// po usunięciu spacji, zamianie |x| na abs(x) i obcięciu "y="
+static void testSpansInSourceText() {
+    struct Case { const char* equation; ParseErrorCode code; size_t position; const char* span; };
+    const Case cases[] = {
+        { "2 x + sin( )", PARSE_MISSING_OPERAND, 11, ")" },
+        { "y = 2 x + foo(x)", PARSE_UNKNOWN_SYMBOL, 10, "foo" },
+        { "y = 3 . . 4 x", PARSE_INVALID_NUMBER, 4, "3 . . 4" },
+        { "f(x) = |x| + qq", PARSE_UNKNOWN_SYMBOL, 13, "qq" },
+        { "y = x + 1 )", PARSE_UNBALANCED_PARENS, 10, ")" },
+        { "  y =  sin x", PARSE_EXPECTED_LPAREN, 11, "x" },
+        { "x^2 + y^2 = -4", PARSE_NEGATIVE_RADIUS, 12, "-4" },
+        { "Y = 2 * * X", PARSE_MISSING_OPERAND, 8, "*" },
+    };
+
+    for (const Case& c : cases) {
+        MathExpressionParser parser;
+        parser.setExpression(c.equation);
+        const ParseError& error = parser.getError();
+        std::string equation = c.equation;
+        CHECK(error.code == c.code);
+        CHECK(error.position == c.position);
+        CHECK(error.position != ParseError::NO_POSITION &&
+              equation.substr(error.position, error.length) == c.span);
+    }
+}
+
+// Brak ')' na końcu wskazuje za ostatni znak, także przy spacjach na końcu
+static void testSpanAtEnd() {
+    MathExpressionParser parser;
+    parser.setExpression("y = (x + 1");
+    CHECK(parser.getError().code == PARSE_UNBALANCED_PARENS);
+    CHECK(parser.getError().position == 10);
+
+    parser.setExpression("y = sin(x   ");
+    CHECK(parser.getError().code == PARSE_UNBALANCED_PARENS);
+    CHECK(parser.getError().position == 12);
+}
+
+// Komunikat cytuje fragment i numer znaku z tekstu użytkownika
+static void testMessageQuotesSource() {
+    MathExpressionParser parser;
+    parser.setExpression("y = 2 x + foo(x)");
+    CHECK(parser.getErrorMessage(LANGUAGE_ENGLISH) == "Parse error: Unknown symbol 'foo' (at 11).");
+
+    parser.setExpression("y = 2 x + sin(x)");
+    CHECK(!parser.hasError());
+}
+
+// Parser z pamięci podręcznej powstał z innego zapisu tego samego wyrażenia;
+// komunikat dla własnego tekstu cytuje i numeruje znaki tego tekstu
+static void testCachedParserQuotesCallerText() {
+    ExpressionCache cache;
+    auto first = cache.get("Y = 2 X + FOO(x)");
+    auto second = cache.get("y=2x+foo(x)");
+    CHECK(first == second);
+    CHECK(second->getErrorMessage("y=2x+foo(x)", LANGUAGE_ENGLISH) == "Parse error: Unknown symbol 'foo' (at 6).");
+    CHECK(first->getErrorMessage("Y = 2 X + FOO(x)", LANGUAGE_ENGLISH) == "Parse error: Unknown symbol 'FOO' (at 11).");
+
+    std::string spaced = "  y = 3 . . 4 x";
+    ParseError error = cache.get("y=3..4x")->getError(spaced);
+    CHECK(error.code == PARSE_INVALID_NUMBER);
+    CHECK(error.position == 6 && spaced.substr(error.position, error.length) == "3 . . 4");
+
+    CHECK(cache.get("y = sin(x")->getError("Y=SIN(X   ").position == 10);
+    CHECK(cache.get("y=sin(x")->getError("y = sin(x").position == 9);
+}
+
+int main() {
+    testSpansInSourceText();
+    testSpanAtEnd();
+    testMessageQuotesSource();
+    testCachedParserQuotesCallerText();
+    return TEST_RESULT();
+}
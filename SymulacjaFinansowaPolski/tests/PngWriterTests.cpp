@@ -0,0 +1,159 @@
+#include "TestCheck.h"
+#include "PngWriter.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Odczyt z powrotem przez zlib: sygnatura, sumy CRC fragmentów, IHDR dla
+// RGB 8 bitów, inflate połączonych IDAT i cofnięcie filtrów wierszy
+static uint32_t readBigEndian(const unsigned char* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+static bool decodePng(const std::string& path, int& width, int& height, std::vector<unsigned char>& rgb,
+                      size_t& fileSize) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    fileSize = data.size();
+    static const unsigned char SIGNATURE[8] = { 137, 'P', 'N', 'G', 13, 10, 26, 10 };
+    if (data.size() < 8 || !std::equal(SIGNATURE, SIGNATURE + 8, data.begin())) return false;
+
+    std::vector<unsigned char> idat;
+    bool header = false, end = false;
+    size_t pos = 8;
+    while (pos + 12 <= data.size() && !end) {
+        uint32_t length = readBigEndian(&data[pos]);
+        if (pos + 12 + length > data.size()) return false;
+        const unsigned char* type = &data[pos + 4];
+        const unsigned char* body = type + 4;
+        if (crc32(crc32(0, Z_NULL, 0), type, length + 4) != readBigEndian(body + length)) return false;
+
+        std::string name(type, type + 4);
+        if (name == "IHDR") {
+            width = (int)readBigEndian(body);
+            height = (int)readBigEndian(body + 4);
+            if (length != 13 || body[8] != 8 || body[9] != 2 || body[12] != 0) return false;
+            header = true;
+        } else if (name == "IDAT") {
+            idat.insert(idat.end(), body, body + length);
+        } else if (name == "IEND") {
+            end = true;
+        }
+        pos += 12 + length;
+    }
+    if (!header || !end || pos != data.size()) return false;
+
+    size_t stride = 3 * (size_t)width;
+    std::vector<unsigned char> raw(height * (stride + 1));
+    uLongf rawSize = raw.size();
+    if (uncompress(raw.data(), &rawSize, idat.data(), idat.size()) != Z_OK || rawSize != raw.size()) return false;
+
+    rgb.assign(height * stride, 0);
+    for (int row = 0; row < height; row++) {
+        int filter = raw[row * (stride + 1)];
+        const unsigned char* in = &raw[row * (stride + 1) + 1];
+        unsigned char* out = &rgb[row * stride];
+        const unsigned char* up = row > 0 ? out - stride : nullptr;
+        for (size_t i = 0; i < stride; i++) {
+            int a = i >= 3 ? out[i - 3] : 0;
+            int b = up ? up[i] : 0;
+            int c = up && i >= 3 ? up[i - 3] : 0;
+            int predictor;
+            switch (filter) {
+                case 0: predictor = 0; break;
+                case 1: predictor = a; break;
+                case 2: predictor = b; break;
+                case 3: predictor = (a + b) / 2; break;
+                case 4: predictor = paeth(a, b, c); break;
+                default: return false;
+            }
+            out[i] = (unsigned char)(in[i] + predictor);
+        }
+    }
+    return true;
+}
+
+static size_t roundTrip(int width, int height, const std::vector<unsigned char>& rgb) {
+    std::string path = (std::filesystem::temp_directory_path() / "PngWriterTests.png").string();
+    PngWriter writer;
+    CHECK(writer.write(path, width, height, rgb));
+
+    int decodedWidth = 0, decodedHeight = 0;
+    std::vector<unsigned char> decoded;
+    size_t fileSize = 0;
+    CHECK(decodePng(path, decodedWidth, decodedHeight, decoded, fileSize));
+    CHECK(decodedWidth == width && decodedHeight == height);
+    CHECK(decoded == rgb);
+    std::filesystem::remove(path);
+    return fileSize;
+}
+
+static std::vector<unsigned char> noise(size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<unsigned char> bytes(count);
+    for (unsigned char& byte : bytes) byte = (unsigned char)(random() >> 24);
+    return bytes;
+}
+
+// Jednolite tło ściska się do ułamka procenta, szum zostaje bez zmian
+static void testFlatAndNoise() {
+    std::vector<unsigned char> flat(3 * 640 * 480);
+    for (size_t i = 0; i < flat.size(); i += 3) {
+        flat[i] = 24;
+        flat[i + 1] = 24;
+        flat[i + 2] = 28;
+    }
+    size_t flatSize = roundTrip(640, 480, flat);
+    CHECK(flatSize < flat.size() / 100);
+
+    roundTrip(97, 61, noise(3 * 97 * 61, 1));
+}
+
+// Obrazy o szerokości jednego piksela: wiersz ma 4 bajty, więc dopasowania
+// obejmują wiele wierszy naraz
+static void testSingleColumn() {
+    roundTrip(1, 1, { 255, 0, 128 });
+    roundTrip(1, 700, noise(3 * 700, 2));
+    std::vector<unsigned char> stripes(3 * 700);
+    for (size_t i = 0; i < stripes.size(); i++) stripes[i] = (unsigned char)(i / 30 % 2 * 200);
+    roundTrip(1, 700, stripes);
+}
+
+// Wiersze szumu powtarzają się co period wierszy: przy 150 wierszach po 193
+// bajty (28950) kopia mieści się w oknie 32 KiB, przy 200 (38600) już nie,
+// a koder nie może wtedy sięgnąć dalej niż okno, czego pilnuje inflate.
+// W oknie plik to niewiele więcej niż jeden okres szumu.
+static void testWindowDistance() {
+    const int WIDTH = 64, HEIGHT = 900;
+    const size_t STRIDE = 3 * WIDTH;
+    for (int period : { 150, 169, 200 }) {
+        std::vector<unsigned char> rows = noise(STRIDE * period, 3 + period);
+        std::vector<unsigned char> rgb(STRIDE * HEIGHT);
+        for (int row = 0; row < HEIGHT; row++) {
+            std::copy_n(&rows[(row % period) * STRIDE], STRIDE, &rgb[row * STRIDE]);
+        }
+        size_t fileSize = roundTrip(WIDTH, HEIGHT, rgb);
+        if (period * (STRIDE + 1) <= 32768) CHECK(fileSize < rows.size() * 3 / 2);
+    }
+}
+
+int main() {
+    testFlatAndNoise();
+    testSingleColumn();
+    testWindowDistance();
+    return TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+#include "TestCheck.h"
+#include "Polyline.h"
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::vector<std::pair<float, float>>> Pieces;
+
+// Łamana z odcinków rozdzielonych breakSegment (przerwy NAN z próbkowania)
+static Polyline makePolyline(const Pieces& pieces) {
+    Polyline line;
+    for (const auto& piece : pieces) {
+        for (const auto& point : piece) line.append(point.first, point.second);
+        line.breakSegment();
+    }
+    return line;
+}
+
+static Pieces toPieces(const Polyline& line) {
+    Pieces pieces;
+    for (const PolylineSegment& segment : line.segments) {
+        pieces.emplace_back();
+        for (unsigned i = segment.begin; i < segment.end; i++) pieces.back().emplace_back(line.x[i], line.y[i]);
+    }
+    return pieces;
+}
+
+static bool samePieces(const Pieces& actual, const Pieces& expected) {
+    if (actual.size() != expected.size()) return false;
+    for (size_t i = 0; i < actual.size(); i++) {
+        if (actual[i].size() != expected[i].size()) return false;
+        for (size_t j = 0; j < actual[i].size(); j++) {
+            if (std::fabs(actual[i][j].first - expected[i][j].first) > 1e-6f ||
+                std::fabs(actual[i][j].second - expected[i][j].second) > 1e-6f) return false;
+        }
+    }
+    return true;
+}
+
+// Prostokąt [-1, 1] x [-1, 1]
+static Pieces clip(const Pieces& input) {
+    Polyline out;
+    out.append(99.0f, 99.0f);   // musi zniknąć, gdy przycinanie coś zmienia
+    if (!clipPolyline(makePolyline(input), -1.0f, 1.0f, -1.0f, 1.0f, out)) return { { { 99.0f, 99.0f } } };
+    return toPieces(out);
+}
+
+static void testClipSegments() {
+    struct Case { const char* name; Pieces input, expected; };
+    const Case cases[] = {
+        { "wjazd", { { { -2, 0 }, { 0, 0 } } }, { { { -1, 0 }, { 0, 0 } } } },
+        { "wyjazd", { { { 0, 0 }, { 2, 0 } } }, { { { 0, 0 }, { 1, 0 } } } },
+        { "przejazd", { { { -2, 0.5f }, { 2, 0.5f } } }, { { { -1, 0.5f }, { 1, 0.5f } } } },
+        { "przejazd po skosie", { { { -3, -2 }, { 3, 1 } } }, { { { -1, -1 }, { 1, 0 } } } },
+        { "obok", { { { 2, 2 }, { 3, -3 } } }, {} },
+        { "po brzegu", { { { -2, 1 }, { 2, 1 } } }, { { { -1, 1 }, { 1, 1 } } } },
+        { "wyjazd i powrót", { { { 0, 0 }, { 2, 0 }, { 2, 0.5f }, { 0, 0.5f } } },
+                             { { { 0, 0 }, { 1, 0 } }, { { 1, 0.5f }, { 0, 0.5f } } } },
+        { "ciągły w środku", { { { -2, 0 }, { 0, 0 }, { 0.5f, 0.5f }, { 2, 0.5f } } },
+                             { { { -1, 0 }, { 0, 0 }, { 0.5f, 0.5f }, { 1, 0.5f } } } },
+        // Przerwa w łamanej zostaje przerwą, nawet gdy oba końce są w środku
+        { "przerwa", { { { -2, 0 }, { 0, 0 } }, { { 0, 0.5f }, { 2, 0.5f } } },
+                     { { { -1, 0 }, { 0, 0 } }, { { 0, 0.5f }, { 1, 0.5f } } } },
+        { "pojedyncze punkty", { { { 0, 0 } }, { { 5, 0 } }, { { 0.5f, 0.5f }, { 3, 0.5f } } },
+                               { { { 0, 0 } }, { { 0.5f, 0.5f }, { 1, 0.5f } } } },
+        { "całość w środku", { { { -1, -1 }, { 0, 0 } }, { { 1, 1 } } }, { { { 99, 99 } } } },
+    };
+    for (const Case& c : cases) {
+        Pieces actual = clip(c.input);
+        if (!samePieces(actual, c.expected)) std::printf("przypadek: %s\n", c.name);
+        CHECK(samePieces(actual, c.expected));
+    }
+}
+
+// Odcinek dotykający tylko narożnika zostawia najwyżej punkt w narożniku
+static void testClipTouchesCorner() {
+    Pieces actual = clip({ { { 0, 2 }, { 2, 0 } } });
+    CHECK(actual.size() <= 1);
+    for (const auto& piece : actual) {
+        for (const auto& point : piece) CHECK(std::fabs(point.first - 1) < 1e-6f && std::fabs(point.second - 1) < 1e-6f);
+    }
+
+    Pieces outside = clip({ { { 0, 2.5f }, { 2.5f, 0 } } });
+    CHECK(outside.empty());
+}
+
+// Gęsta łamana z przerwami po przycięciu i redukcji: najwyżej 4 punkty na
+// kolumnę zakresu plus 4 na przerwę, a w każdej kolumnie zostają skrajne y
+static void testDecimateBound() {
+    Polyline dense;
+    for (int i = 0; i < 200000; i++) {
+        float x = -30.0f + i * 0.0003f;
+        if (i % 50000 == 0) dense.breakSegment();
+        dense.append(x, std::sin(x * 40.0f) * 20.0f);
+    }
+    const int columns = 300;
+    Polyline decimated;
+    decimatePixelColumns(dense, -30.0f, 30.0f, columns, decimated);
+    CHECK(decimated.size() <= 4 * (size_t)columns + 4 * dense.segments.size());
+    CHECK(decimated.segments.size() == dense.segments.size());
+
+    float lowest = 0.0f, highest = 0.0f;
+    for (size_t i = 0; i < decimated.size(); i++) {
+        lowest = std::fmin(lowest, decimated.y[i]);
+        highest = std::fmax(highest, decimated.y[i]);
+    }
+    CHECK(lowest < -19.99f && highest > 19.99f);
+}
+
+int main() {
+    testClipSegments();
+    testDecimateBound();
+    testClipTouchesCorner();
+    return TEST_RESULT();
+}
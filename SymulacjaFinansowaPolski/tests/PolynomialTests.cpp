@@ -0,0 +1,72 @@
+#include "TestCheck.h"
+#include "MathExpressionParser.h"
+#include <vector>
+#include <span>
+
+// (x - shift)^power policzone w double z tych samych x co wykres
+static double shiftedPower(double x, double shift, int power) {
+    return std::pow(x - shift, power);
+}
+
+// Przesunięte potęgi nie mogą trafić do Hornera po rozwinięciu: współczynniki
+// rzędu shift^power znoszą się w float i przy pierwiastku wynik jest zły
+// o rzędy wielkości (np. (x-100)^4 dawało -1.43 przy x = 99.9)
+static void testShiftedPowers() {
+    struct Case { const char* equation; double shift; int power; };
+    const Case cases[] = {
+        { "y=(x-100)^4", 100.0, 4 },
+        { "y=(x-10)^6", 10.0, 6 },
+        { "y=(x-3)^8", 3.0, 8 },
+        { "y=(x+50)^5", -50.0, 5 },
+    };
+
+    for (const Case& c : cases) {
+        MathExpressionParser parser;
+        parser.setExpression(c.equation);
+        CHECK(!parser.hasError());
+
+        std::vector<float> xs;
+        for (int i = -100; i <= 100; i++) xs.push_back(static_cast<float>(c.shift + i * 0.01));
+        std::vector<float> ys(xs.size());
+        parser.evaluateBatch(std::span<const float>(xs), std::span<float>(ys));
+        std::vector<double> xd(xs.begin(), xs.end()), yd(xs.size());
+        parser.evaluateBatch(std::span<const double>(xd), std::span<double>(yd));
+
+        for (size_t i = 0; i < xs.size(); i++) {
+            double expected = shiftedPower(xs[i], c.shift, c.power);
+            CHECK_NEAR(parser.evaluate(xs[i]), expected, 1e-4, 1e-30);
+            CHECK_NEAR(ys[i], expected, 1e-4, 1e-30);
+            CHECK_NEAR(yd[i], expected, 1e-9, 1e-30);
+        }
+    }
+}
+
+// Wielomiany wpisane jako suma jednomianów dalej idą szybką ścieżką
+static void testMonomialFormStaysFast() {
+    struct Case { const char* equation; bool polynomial; };
+    const Case cases[] = {
+        { "y=x^3-2x+1", true },
+        { "y=2*(x-1)", true },          // mnożenie przez stałą
+        { "y=x*(x+1)", true },          // mnożenie przez jednomian
+        { "y=(3x)^4", true },           // potęga jednomianu
+        { "y=(x-1)*(x+1)", false },     // iloczyn wymagałby rozwinięcia
+        { "y=(x-1)^2", false },
+    };
+    for (const Case& c : cases) {
+        MathExpressionParser parser;
+        parser.setExpression(c.equation);
+        CHECK(parser.getProgram().isPolynomial() == c.polynomial);
+    }
+
+    MathExpressionParser parser;
+    parser.setExpression("y=x^3-2x+1");
+    for (float x = -3.0f; x <= 3.0f; x += 0.25f) {
+        CHECK_NEAR(parser.evaluate(x), (double)x * x * x - 2.0 * x + 1.0, 1e-5, 1.0);
+    }
+}
+
+int main() {
+    testShiftedPowers();
+    testMonomialFormStaysFast();
+    return TEST_RESULT();
+}
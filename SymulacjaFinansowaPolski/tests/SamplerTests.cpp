@@ -0,0 +1,157 @@
+#include "TestCheck.h"
+#include "FunctionSampler.h"
+#include "TaskScheduler.h"
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static std::shared_ptr<const MathExpressionParser> compile(const char* equation) {
+    auto parser = std::make_shared<MathExpressionParser>();
+    parser->setExpression(equation);
+    return parser;
+}
+
+// Widok [-10, 10] x [-10, 10] z marginesem jak w MultiFunctionPlotter
+static SamplingJob makeJob(float xMin, float xMax) {
+    SamplingJob job;
+    job.version = 1;
+    job.xMin = xMin;
+    job.xMax = xMax;
+    job.pixelWidth = 800;
+    job.pixelHeight = 800;
+    job.yMin = -10.0f;
+    job.yMax = 10.0f;
+    float width = xMax - xMin;
+    job.clipXMin = xMin - width;
+    job.clipXMax = xMax + width;
+    job.clipYMin = -30.0f;
+    job.clipYMax = 30.0f;
+    return job;
+}
+
+// Każdy punkt krzywej leży na wykresie (przerwy NAN pomijamy)
+static bool followsFunction(const Polyline& curve, double (*function)(double)) {
+    if (curve.size() == 0) return false;
+    for (size_t i = 0; i < curve.size(); i++) {
+        if (std::isnan(curve.y[i])) continue;
+        if (std::fabs(curve.y[i] - function(curve.x[i])) > 1e-4) return false;
+    }
+    return true;
+}
+
+static double sinFunction(double x) { return std::sin(x); }
+static double cosFunction(double x) { return std::cos(x); }
+
+// Dwa zlecenia złączone w jedno: B zmienione na wyrażenie A i dodane C
+// z dawnym wyrażeniem B. Parsery na kolejnych miejscach są takie same jak
+// przy budowie grafu, ale należą do innych funkcji, więc graf trzeba przebudować.
+static void testGraphFollowsFunctionIds() {
+    auto sinParser = compile("y=sin(x)");
+    auto cosParser = compile("y=cos(x)");
+    FunctionSampler sampler;
+    SamplingResult result;
+
+    SamplingJob first = makeJob(-10.0f, 10.0f);
+    first.ids = { 0, 1 };
+    first.parsers = { sinParser, cosParser };
+    first.liveIds = { 0, 1 };
+    sampler.run(first, result);
+    CHECK(followsFunction(result.curves[0], sinFunction));
+    CHECK(followsFunction(result.curves[1], cosFunction));
+
+    SamplingJob second = makeJob(-10.0f, 10.0f);
+    second.version = 2;
+    second.ids = { 1, 2 };
+    second.parsers = { sinParser, cosParser };
+    second.liveIds = { 0, 1, 2 };
+    sampler.run(second, result);
+    CHECK(followsFunction(result.curves[0], sinFunction));
+    CHECK(followsFunction(result.curves[1], cosFunction));
+}
+
+// Te same punkty i odcinki co do bitu (NAN w przerwach też)
+static bool sameCurve(const Polyline& a, const Polyline& b) {
+    if (a.size() != b.size() || a.segments.size() != b.segments.size()) return false;
+    for (size_t i = 0; i < a.segments.size(); i++) {
+        if (a.segments[i].begin != b.segments[i].begin || a.segments[i].end != b.segments[i].end) return false;
+    }
+    return std::memcmp(a.x.data(), b.x.data(), a.size() * sizeof(float)) == 0 &&
+           std::memcmp(a.y.data(), b.y.data(), a.size() * sizeof(float)) == 0;
+}
+
+static bool sameResult(const SamplingResult& a, const SamplingResult& b) {
+    if (a.evaluations != b.evaluations || a.curves.size() != b.curves.size()) return false;
+    for (size_t i = 0; i < a.curves.size(); i++) {
+        if (!sameCurve(a.curves[i], b.curves[i]) || !sameCurve(a.rendered[i], b.rendered[i])) return false;
+    }
+    return true;
+}
+
+// Funkcje z grafu, wielomiany, asymptoty i granice dziedziny w jednym
+// zleceniu; parsery są wspólne dla wszystkich zleceń, jak z ExpressionCache
+static SamplingJob mixedJob(float xMin, float xMax) {
+    static const std::vector<std::shared_ptr<const MathExpressionParser>> parsers = {
+        compile("y=sin(x)"), compile("y=tan(x)"), compile("y=1/x"), compile("y=x^3/20-x"),
+        compile("y=ln(x)"), compile("y=abs(x)^0.5"), compile("y=sin(x)*cos(3x)"), compile("y=exp(-x^2)*5")
+    };
+    SamplingJob job = makeJob(xMin, xMax);
+    for (unsigned i = 0; i < parsers.size(); i++) {
+        job.ids.push_back(i);
+        job.parsers.push_back(parsers[i]);
+        job.liveIds.push_back(i);
+    }
+    return job;
+}
+
+// Wynik nie zależy od liczby wątków: ten sam przebieg (także z pamięcią
+// kafelków po przesunięciu) daje identyczne krzywe przy 1 i 4 wątkach
+static void testThreadCountDeterminism() {
+    TaskScheduler& scheduler = getTaskScheduler();
+    unsigned previous = scheduler.getThreadCount();
+
+    SamplingResult single[2], parallel[2];
+    const unsigned counts[] = { 1, 4 };
+    for (int c = 0; c < 2; c++) {
+        scheduler.setThreadCount(counts[c]);
+        FunctionSampler sampler;
+        SamplingResult* results = c == 0 ? single : parallel;
+        sampler.run(mixedJob(-10.0f, 10.0f), results[0]);
+        sampler.run(mixedJob(-7.3f, 12.7f), results[1]);
+    }
+    CHECK(sameResult(single[0], parallel[0]));
+    CHECK(sameResult(single[1], parallel[1]));
+
+    scheduler.setThreadCount(previous);
+}
+
+// Przesunięcie widoku przy ciepłej pamięci liczy tylko odsłonięte kafelki:
+// widok ma 40 kafelków (szerokość 0.5), przesunięcie o 2 odsłania 4 z nich.
+// Powrót do poprzedniego widoku nie liczy niczego, a krzywe są takie same
+// jak z pustej pamięci.
+static void testPanReusesTiles() {
+    SamplingJob start = mixedJob(-10.0f, 10.0f);
+    SamplingJob panned = mixedJob(-8.0f, 12.0f);
+
+    FunctionSampler fresh;
+    SamplingResult full;
+    fresh.run(panned, full);
+
+    FunctionSampler warm;
+    SamplingResult result;
+    warm.run(start, result);
+    warm.run(panned, result);
+    CHECK(result.evaluations > 0);
+    CHECK(result.evaluations * 5 < full.evaluations);
+    for (size_t i = 0; i < full.curves.size(); i++) CHECK(sameCurve(result.curves[i], full.curves[i]));
+
+    warm.run(start, result);
+    CHECK(result.evaluations == 0);
+}
+
+int main() {
+    testGraphFollowsFunctionIds();
+    testThreadCountDeterminism();
+    testPanReusesTiles();
+    return TEST_RESULT();
+}
@@ -0,0 +1,32 @@
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+// Minimalne asercje testów: błąd jest wypisywany i liczony, test leci dalej,
+// a main zwraca TEST_RESULT() jako kod wyjścia
+static int testFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::printf("%s:%d: CHECK(%s)\n", __FILE__, __LINE__, #condition); \
+            testFailures++; \
+        } \
+    } while (0)
+
+// Błąd względny względem max(|expected|, scale)
+#define CHECK_NEAR(actual, expected, tolerance, scale) \
+    do { \
+        double a_ = (actual), e_ = (expected); \
+        double limit_ = (tolerance) * std::fmax(std::fabs(e_), (scale)); \
+        if (!(std::fabs(a_ - e_) <= limit_)) { \
+            std::printf("%s:%d: %s = %.9g, oczekiwano %.9g\n", __FILE__, __LINE__, #actual, a_, e_); \
+            testFailures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
+
+#endif // TESTCHECK_H
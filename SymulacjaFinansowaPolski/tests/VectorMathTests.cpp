@@ -0,0 +1,193 @@
+#include "TestCheck.h"
+#include "VectorMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Każda wersja jąder dostępna na tym procesorze porównana z <cmath> dla float
+// na losowych argumentach, z granicami ULP z komentarza w VectorMath.h
+static const size_t SAMPLES = 100000;
+
+static int64_t orderedBits(float value) {
+    int32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? (int64_t)INT32_MIN - bits : bits;
+}
+
+// Odległość w ULP; NAN zgadza się tylko z NAN, nieskończoności tylko ze sobą
+static double ulpDistance(float actual, float expected) {
+    if (std::isnan(actual) || std::isnan(expected)) return std::isnan(actual) && std::isnan(expected) ? 0.0 : INFINITY;
+    if (std::isinf(actual) || std::isinf(expected)) return actual == expected ? 0.0 : INFINITY;
+    return (double)std::llabs(orderedBits(actual) - orderedBits(expected));
+}
+
+static std::mt19937 random32(12345);
+
+static std::vector<float> uniform(float low, float high, size_t count = SAMPLES) {
+    std::uniform_real_distribution<float> distribution(low, high);
+    std::vector<float> xs(count);
+    for (float& x : xs) x = distribution(random32);
+    return xs;
+}
+
+// Dodatnie liczby o losowych bitach: wszystkie wykładniki po równo, także
+// liczby zdenormalizowane
+static std::vector<float> positiveBits() {
+    std::vector<float> xs(SAMPLES);
+    for (float& x : xs) {
+        uint32_t bits = random32() % 0x7F800000u;
+        std::memcpy(&x, &bits, sizeof(x));
+        if (x == 0.0f) x = 1.0f;
+    }
+    return xs;
+}
+
+static void report(const char* kernel, const char* function, double worst, double bound) {
+    if (worst > bound) std::printf("  %s %s: %.0f ULP > %.0f\n", kernel, function, worst, bound);
+}
+
+// Jednoargumentowa funkcja jądra na całej tablicy naraz (długość nie jest
+// wielokrotnością szerokości wektora, więc sprawdzany jest też ogon)
+template <typename Reference>
+static double worstUnary(void (*kernel)(float*, size_t), const std::vector<float>& xs, Reference reference) {
+    std::vector<float> ys(xs.begin(), xs.end() - 3);
+    kernel(ys.data(), ys.size());
+    double worst = 0.0;
+    for (size_t i = 0; i < ys.size(); i++) worst = std::fmax(worst, ulpDistance(ys[i], reference(xs[i])));
+    return worst;
+}
+
+static void testTrigonometry(const VectorMathKernels& k) {
+    std::vector<float> xs = uniform(-8192.0f, 8192.0f);
+    std::vector<float> small = uniform(-4.0f, 4.0f);
+    xs.insert(xs.end(), small.begin(), small.end());
+    double worst;
+
+    worst = worstUnary(k.sin, xs, [](float x) { return std::sin(x); });
+    report(k.name, "sin", worst, 2.0);
+    CHECK(worst <= 2.0);
+
+    worst = worstUnary(k.cos, xs, [](float x) { return std::cos(x); });
+    report(k.name, "cos", worst, 2.0);
+    CHECK(worst <= 2.0);
+
+    // Przy |tan| blisko progu NAN wersje mogą wybrać różne strony progu
+    auto tangent = [](float x) {
+        float t = std::tan(x);
+        return std::fabs(t) > 1e4f ? NAN : t;
+    };
+    std::vector<float> tanArgs;
+    for (float x : xs) {
+        if (std::fabs(std::fabs(std::tan(x)) - 1e4f) > 1.0f) tanArgs.push_back(x);
+    }
+    worst = worstUnary(k.tan, tanArgs, tangent);
+    report(k.name, "tan", worst, 3.0);
+    CHECK(worst <= 3.0);
+
+    // Poza |x| <= 8192 jądra wołają std:: bez zmian
+    std::vector<float> large = uniform(8200.0f, 1e7f);
+    CHECK(worstUnary(k.sin, large, [](float x) { return std::sin(x); }) == 0.0);
+    CHECK(worstUnary(k.cos, large, [](float x) { return std::cos(x); }) == 0.0);
+}
+
+static void testExponentAndLogarithms(const VectorMathKernels& k) {
+    double worst = worstUnary(k.exp, uniform(-110.0f, 95.0f), [](float x) { return std::exp(x); });
+    report(k.name, "exp", worst, 1.0);
+    CHECK(worst <= 1.0);
+
+    std::vector<float> positive = positiveBits();
+    worst = worstUnary(k.ln, positive, [](float x) { return std::log(x); });
+    report(k.name, "ln", worst, 1.0);
+    CHECK(worst <= 1.0);
+
+    worst = worstUnary(k.log10, positive, [](float x) { return std::log10(x); });
+    report(k.name, "log10", worst, 2.0);
+    CHECK(worst <= 2.0);
+
+    std::vector<float> outside = { 0.0f, -0.0f, -1.0f, -INFINITY };
+    k.ln(outside.data(), outside.size());
+    for (float y : outside) CHECK(std::isnan(y));
+}
+
+// Wykładnik całkowity: square-and-multiply, gdzie każde podniesienie do
+// kwadratu podwaja wcześniejszy błąd, więc granica rośnie z |n|, a nie
+// z liczbą mnożeń (i jedno dzielenie przy ujemnym wykładniku)
+static void testPowers(const VectorMathKernels& k) {
+    std::vector<float> bases = uniform(0.5f, 2.0f, SAMPLES / 50);
+    std::vector<float> negative = uniform(-2.0f, -0.5f, SAMPLES / 50);
+    bases.insert(bases.end(), negative.begin(), negative.end());
+    for (int n = -64; n <= 64; n++) {
+        std::vector<float> ys(bases);
+        k.powConst(ys.data(), (float)n, ys.size());
+        unsigned e = (unsigned)std::abs(n);
+        double bound = e + (n < 0 ? 1 : 0);
+        double worst = 0.0;
+        for (size_t i = 0; i < ys.size(); i++) {
+            float power = std::pow(bases[i], (float)e);
+            // Przy |a^n| blisko progu 1e-6 dzielenie może trafić na drugą stronę progu
+            if (n < 0 && std::fabs(std::fabs(power) / 1e-6f - 1.0f) < 1e-3f) continue;
+            float expected = n >= 0 ? power : std::fabs(power) < 1e-6f ? NAN : 1.0f / power;
+            worst = std::fmax(worst, ulpDistance(ys[i], expected));
+        }
+        report(k.name, "powConst", worst, bound);
+        CHECK(worst <= bound);
+    }
+
+    // Pozostałe exp(b*ln|a|): granica 2 + 2*|b*ln a|
+    std::vector<float> as = uniform(0.01f, 100.0f), bs = uniform(-6.0f, 6.0f);
+    std::vector<float> ys(as);
+    k.pow(ys.data(), bs.data(), ys.size());
+    bool within = true;
+    for (size_t i = 0; i < ys.size(); i++) {
+        double bound = 2.0 + 2.0 * std::fabs(bs[i] * std::log(as[i]));
+        double error = ulpDistance(ys[i], std::pow(as[i], bs[i]));
+        if (error > bound) {
+            report(k.name, "pow", error, bound);
+            within = false;
+            break;
+        }
+    }
+    CHECK(within);
+}
+
+// + - * / dokładne, dzielenie przez |b| < 1e-6 daje NAN
+static void testArithmetic(const VectorMathKernels& k) {
+    std::vector<float> as = uniform(-1e3f, 1e3f), bs = uniform(-1e3f, 1e3f);
+    bs[0] = 0.0f;
+    bs[1] = 5e-7f;
+    std::vector<float> sum(as), difference(as), product(as), quotient(as);
+    k.add(sum.data(), bs.data(), as.size());
+    k.sub(difference.data(), bs.data(), as.size());
+    k.mul(product.data(), bs.data(), as.size());
+    k.div(quotient.data(), bs.data(), as.size());
+
+    bool exact = true;
+    for (size_t i = 0; i < as.size(); i++) {
+        float expectedQuotient = std::fabs(bs[i]) < 1e-6f ? NAN : as[i] / bs[i];
+        exact = exact && sum[i] == as[i] + bs[i] && difference[i] == as[i] - bs[i] && product[i] == as[i] * bs[i] &&
+                ulpDistance(quotient[i], expectedQuotient) == 0.0;
+    }
+    CHECK(exact);
+    CHECK(std::isnan(quotient[0]) && std::isnan(quotient[1]));
+}
+
+int main() {
+    int tested = 0;
+    for (const char* name : { "avx2", "sse4.1", "scalar" }) {
+        VectorMathKernels kernels;
+        if (!loadVectorMathKernels(name, kernels)) {
+            std::printf("%s: niedostępne na tym procesorze\n", name);
+            continue;
+        }
+        tested++;
+        testTrigonometry(kernels);
+        testExponentAndLogarithms(kernels);
+        testPowers(kernels);
+        testArithmetic(kernels);
+    }
+    CHECK(tested > 0);
+    return TEST_RESULT();
+}